@@ -5,42 +5,77 @@
 class AddProcessor : public ProcessorBase
 {
 public:
-    AddProcessor(std::string newUniqueName, std::vector<float> gainLevels) : ProcessorBase(newUniqueName), myGainLevels{ gainLevels } {
+    AddProcessor(std::string newUniqueName, std::vector<float> gainLevels) :
+        ProcessorBase([numGains = (int)gainLevels.size()]() { return createParameterLayout(numGains); }, newUniqueName),
+        myNumGainParameters{ (int)gainLevels.size() } {
+        setGainLevels(gainLevels);
     }
 
-    void prepareToPlay(double, int) {
-
+    void prepareToPlay(double, int samplesPerBlock) {
+        myInputCopy.setSize(getTotalNumInputChannels(), samplesPerBlock);
     }
 
     void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer& midiBuffer) {
-        // Buffer will be an even number of channels, assuming we're doing stereo audio.
-        // Speaking in terms of zero index channels, we need to read from channels 2, 4, 6... etc
-        // and add them to write channel 0.
-        // Similarly we need to read from channels 3, 5, 7.. etc and add them to
-        // write channel 1.
+        // The inputs are laid out one after another. When every input has as many channels as the output,
+        // with N channels, channel c of the output is the sum of channels c, N + c, 2N + c... etc
 
-        const int numInputs = buffer.getNumChannels() / 2;
+        const int numChannels = std::max(1, getTotalNumOutputChannels());
+        const int numInputs = myInputChannelCounts.empty() ? getTotalNumInputChannels() / numChannels : (int)myInputChannelCounts.size();
 
-        if (numInputs != myGainLevels.size() && myGainLevels.size()!=0) {
-            // The size of myGainLevels doesn't match the number of inputs,
-            // and the size of myGainLevels isn't zero. If it were zero,
-            // getSafeGainLevel(index) will know to use 1.0f for every gain.
+        if (numInputs != myNumGainLevels && myNumGainLevels != 0) {
+            // The number of gain levels doesn't match the number of inputs,
+            // and the number of gain levels isn't zero. If it were zero,
+            // every gain would be 1.0f.
 
             // todo: throw graceful error
             return;
         }
 
-        const int numTimesToSum = numInputs - 1;
+        AudioPlayHead::CurrentPositionInfo posInfo;
+        getPlayHead()->getCurrentPosition(posInfo);
 
-        const auto readptrs = buffer.getArrayOfReadPointers();
+        for (int i = 0; i < myNumGainLevels; i++) {
+            myGains[i] = getBoundAutomationVal(i, posInfo.timeInSamples);
+        }
 
-        buffer.applyGain(0, 0, buffer.getNumSamples(), getSafeGainLevel(0));
-        buffer.applyGain(1, 0, buffer.getNumSamples(), getSafeGainLevel(0));
+        bool isSameWidth = true;
+        for (auto numInputChannels : myInputChannelCounts) {
+            isSameWidth = isSameWidth && numInputChannels == numChannels;
+        }
+        if (!isSameWidth) {
+            sumInputsOfDifferentWidths(buffer, numChannels, numInputs);
+            ProcessorBase::processBlock(buffer, midiBuffer);
+            return;
+        }
+
+        // Output channel c is input channel c of the first input, so it's summed in place. The samples are summed
+        // a tile at a time, so every input is added to the tile while it's still in the cache, and the output is
+        // written to memory once instead of once per input.
+        const int numSamples = buffer.getNumSamples();
+        const auto readptrs = buffer.getArrayOfReadPointers();
 
-        for (int sumIndex = 0; sumIndex < numTimesToSum; sumIndex++)
-        {
-            buffer.addFrom(0, 0, readptrs[2 + sumIndex * 2], buffer.getNumSamples(), getSafeGainLevel(sumIndex + 1));
-            buffer.addFrom(1, 0, readptrs[3 + sumIndex * 2], buffer.getNumSamples(), getSafeGainLevel(sumIndex + 1));
+        for (int chan = 0; chan < numChannels; chan++) {
+            float* output = buffer.getWritePointer(chan);
+
+            for (int tileStart = 0; tileStart < numSamples; tileStart += tileSize) {
+                const int tileLength = std::min(tileSize, numSamples - tileStart);
+                float* outputTile = output + tileStart;
+
+                if (getSafeGainLevel(0) != 1.f) {
+                    juce::FloatVectorOperations::multiply(outputTile, getSafeGainLevel(0), tileLength);
+                }
+
+                for (int input = 1; input < numInputs; input++) {
+                    const float* inputTile = readptrs[input * numChannels + chan] + tileStart;
+                    const float gain = getSafeGainLevel(input);
+                    if (gain == 1.f) {
+                        juce::FloatVectorOperations::add(outputTile, inputTile, tileLength);
+                    }
+                    else {
+                        juce::FloatVectorOperations::addWithMultiply(outputTile, inputTile, gain, tileLength);
+                    }
+                }
+            }
         }
 
         ProcessorBase::processBlock(buffer, midiBuffer);
@@ -51,19 +86,101 @@ public:
 
     const juce::String getName() { return "AddProcessor"; };
 
-    void setGainLevels(const std::vector<float> gainLevels) { myGainLevels = gainLevels; }
-    const std::vector<float> getGainLevels() { return myGainLevels; }
+    bool canSkipWhenSilent() { return true; }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new AddProcessor(newUniqueName, getGainLevels());
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
+    // The gain of input i is the automatable parameter "gain_i". The parameters are made by the constructor,
+    // so there can't be more gain levels than the processor was made with.
+    void setGainLevels(const std::vector<float> gainLevels) {
+        if ((int)gainLevels.size() > myNumGainParameters) {
+            std::cerr << "Error: AddProcessor " << getUniqueName() << " was made with " << myNumGainParameters
+                << " gain levels and can't have more." << std::endl;
+            return;
+        }
+
+        std::vector<std::string> parameterNames;
+        for (int i = 0; i < (int)gainLevels.size(); i++) {
+            auto parameterName = "gain_" + std::to_string(i);
+            setAutomationVal(parameterName, gainLevels[i]);
+            parameterNames.push_back(parameterName);
+        }
+        bindParameters(parameterNames);
+        myNumGainLevels = (int)gainLevels.size();
+        myGains.resize(myNumGainLevels);
+    }
+
+    const std::vector<float> getGainLevels() {
+        std::vector<float> gainLevels;
+        for (int i = 0; i < myNumGainLevels; i++) {
+            gainLevels.push_back(getBoundAutomationVal(i, 0));
+        }
+        return gainLevels;
+    }
 
 
 private:
 
-    std::vector<float> myGainLevels;
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(int numGains)
+    {
+        juce::AudioProcessorValueTreeState::ParameterLayout params;
+
+        for (int i = 0; i < numGains; i++) {
+            auto parameterName = "gain_" + std::to_string(i);
+            params.add(std::make_unique<AutomateParameterFloat>(parameterName, parameterName, NormalisableRange<float>(-100.f, 100.f), 1.f));
+        }
+        return params;
+    }
+
+    // Sum inputs whose channel counts differ from the output's. A mono input goes to every output channel, and any
+    // other input only adds to the output channels it has. The inputs are copied first, since the output overwrites them.
+    void sumInputsOfDifferentWidths(juce::AudioSampleBuffer& buffer, int numChannels, int numInputs) {
+        const int numSamples = buffer.getNumSamples();
+        const int numInputChannels = std::min(getTotalNumInputChannels(), buffer.getNumChannels());
+
+        myInputCopy.setSize(numInputChannels, numSamples, false, false, true);
+        for (int chan = 0; chan < numInputChannels; chan++) {
+            myInputCopy.copyFrom(chan, 0, buffer, chan, 0, numSamples);
+        }
+        for (int chan = 0; chan < numChannels; chan++) {
+            buffer.clear(chan, 0, numSamples);
+        }
+
+        int firstChannel = 0;
+        for (int input = 0; input < numInputs; input++) {
+            const int width = myInputChannelCounts[input];
+            const float gain = getSafeGainLevel(input);
+            for (int chan = 0; chan < numChannels; chan++) {
+                const int source = firstChannel + (width == 1 ? 0 : chan);
+                if ((width == 1 || chan < width) && source < numInputChannels) {
+                    buffer.addFrom(chan, 0, myInputCopy, source, 0, numSamples, gain);
+                }
+            }
+            firstChannel += width;
+        }
+    }
+
+    // A copy of the inputs for sumInputsOfDifferentWidths.
+    juce::AudioSampleBuffer myInputCopy;
+
+    // The number of samples summed at a time, which keeps the tile of the output in the L1 cache.
+    static constexpr int tileSize = 256;
+
+    int myNumGainParameters = 0;
+    int myNumGainLevels = 0;
+
+    // The gain of every input for the current block.
+    std::vector<float> myGains;
 
     float getSafeGainLevel(int index) {
-        if (myGainLevels.size() == 0) {
+        if (myNumGainLevels == 0) {
             return 1.f;
         }
-        return myGainLevels.at(index);
+        return myGains[index];
     }
 
-};
\ No newline at end of file
+};
@@ -18,11 +18,13 @@ public:
         myAttack = myParameters.getRawParameterValue("attack");
         myRelease = myParameters.getRawParameterValue("release");
 
+        bindParameters({ "threshold", "ratio", "attack", "release" });
+
         updateParameters();
     }
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) {
-        juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32> (samplesPerBlock), 2 };
+        juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32> (samplesPerBlock), static_cast<juce::uint32> (getTotalNumOutputChannels()) };
         myCompressor.prepare(spec);
     }
 
@@ -30,7 +32,7 @@ public:
 
         automateParameters();
 
-        juce::dsp::AudioBlock<float> block(buffer);
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, (size_t)getTotalNumOutputChannels());
         juce::dsp::ProcessContextReplacing<float> context(block);
         myCompressor.process(context);
         ProcessorBase::processBlock(buffer, midiBuffer);
@@ -41,10 +43,10 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        *myThreshold = getAutomationVal("threshold", posInfo.timeInSamples);
-        *myRatio = getAutomationVal("ratio", posInfo.timeInSamples);
-        *myAttack = getAutomationVal("attack", posInfo.timeInSamples);
-        *myRelease = getAutomationVal("release", posInfo.timeInSamples);
+        *myThreshold = getBoundAutomationVal(Threshold, posInfo.timeInSamples);
+        *myRatio = getBoundAutomationVal(Ratio, posInfo.timeInSamples);
+        *myAttack = getBoundAutomationVal(Attack, posInfo.timeInSamples);
+        *myRelease = getBoundAutomationVal(Release, posInfo.timeInSamples);
         updateParameters();
     }
 
@@ -54,6 +56,19 @@ public:
 
     const juce::String getName() { return "CompressorProcessor"; };
 
+    bool canSkipWhenSilent() { return true; }
+
+    void clearTail() { reset(); }
+
+    // The time for the envelope to release by 100 dB, after which silence in gives the same state as a reset.
+    double getTailLengthSeconds() const { return 11.5 * myRelease->load() * .001; }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new CompressorProcessor(newUniqueName, getThreshold(), getRatio(), getAttack(), getRelease());
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
     void setThreshold(float threshold) { setAutomationVal("threshold", threshold); }
     float getThreshold() { return getAutomationVal("threshold", 0); }
 
@@ -68,6 +83,9 @@ public:
 
 
 private:
+    // The order of bindParameters.
+    enum BoundParameter { Threshold, Ratio, Attack, Release };
+
     juce::dsp::Compressor<float> myCompressor;
     std::atomic<float>* myThreshold;
     std::atomic<float>* myRatio;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "TempoMap.h"
 
 using juce::ADSR;
 using juce::AbstractFifo;
@@ -112,26 +113,38 @@ using juce::roundFloatToInt;
 using juce::roundToInt;
 using juce::uint8;
 
+// A point of a breakpoint envelope. The curve shapes the segment that starts at the point:
+// 0 is linear, positive values rise slowly at first and negative values rise quickly at first.
+class AutomationBreakpoint
+{
+public:
+    double time;
+    float value;
+    float curve;
+};
+
 class AutomateParameter
 {
 
 public:
 
+    // How the automation is stored. Samples holds one value per audio sample. Control holds values
+    // at a lower rate that are interpolated linearly. Breakpoints holds an envelope of AutomationBreakpoints.
+    enum class AutomationMode { Samples, Control, Breakpoints };
+
     AutomateParameter() {}
 
-    bool setAutomation(py::array_t<float> input) {
+    bool setAutomation(py::array_t<float, py::array::c_style | py::array::forcecast> input) {
 
         try
         {
-            float* input_ptr = (float*)input.data();
-            myAutomation.clear();
-
-            myAutomation = std::vector<float>(input.shape(0), 0.f);
-
-            for (int x = 0; x < input.shape(0); x++) {
-                myAutomation[x] = *(input_ptr++);
+            if (input.ndim() != 1 || input.shape(0) == 0) {
+                throw std::invalid_argument("The automation must be a non-empty one-dimensional array.");
             }
-
+            const float* input_ptr = input.data();
+            myAutomation.assign(input_ptr, input_ptr + input.shape(0));
+            myMode = AutomationMode::Samples;
+            myBreakpoints.clear();
         }
         catch (const std::exception& e)
         {
@@ -142,16 +155,155 @@ public:
         return true;
     }
 
+    // Values at controlRate per second, or per quarter note if ppq is true.
+    bool setControlAutomation(py::array_t<float, py::array::c_style | py::array::forcecast> input, double controlRate, bool ppq) {
+
+        if (controlRate <= 0.) {
+            std::cout << "Error: setAutomation: the rate of control automation must be positive." << std::endl;
+            return false;
+        }
+
+        if (!setAutomation(input)) {
+            return false;
+        }
+
+        myMode = AutomationMode::Control;
+        myControlRate = controlRate;
+        myIsPPQ = ppq;
+
+        return true;
+    }
+
+    // Rows of (time, value) or (time, value, curve), with times in seconds, or in quarter notes if ppq is true.
+    bool setBreakpointAutomation(py::array_t<double, py::array::c_style | py::array::forcecast> input, bool ppq) {
+
+        if (input.ndim() != 2 || input.shape(0) == 0 || input.shape(1) < 2 || input.shape(1) > 3) {
+            std::cout << "Error: setAutomation: breakpoints must be an array of shape (N, 2) or (N, 3)." << std::endl;
+            return false;
+        }
+
+        const double* input_ptr = input.data();
+        const py::ssize_t numColumns = input.shape(1);
+
+        std::vector<AutomationBreakpoint> breakpoints;
+        breakpoints.reserve(input.shape(0));
+        for (py::ssize_t i = 0; i < input.shape(0); i++, input_ptr += numColumns) {
+            AutomationBreakpoint breakpoint{ input_ptr[0], (float)input_ptr[1], numColumns > 2 ? (float)input_ptr[2] : 0.f };
+            if (!breakpoints.empty() && breakpoint.time < breakpoints.back().time) {
+                std::cout << "Error: setAutomation: the times of breakpoints must be in ascending order." << std::endl;
+                return false;
+            }
+            breakpoints.push_back(breakpoint);
+        }
+
+        myBreakpoints = std::move(breakpoints);
+        myAutomation.clear();
+        myMode = AutomationMode::Breakpoints;
+        myIsPPQ = ppq;
+
+        return true;
+    }
+
     void setAutomation(const float val) {
         myAutomation.clear();
         myAutomation.push_back(val);
+        myMode = AutomationMode::Samples;
+        myBreakpoints.clear();
     }
 
+    void setAutomation(const std::vector<float>& values) {
+        myAutomation = values;
+        myMode = AutomationMode::Samples;
+        myBreakpoints.clear();
+    }
+
+    // Copy another parameter's automation in whatever form it's stored.
+    void copyAutomation(const AutomateParameter& other) {
+        myMode = other.myMode;
+        myAutomation = other.myAutomation;
+        myBreakpoints = other.myBreakpoints;
+        myControlRate = other.myControlRate;
+        myIsPPQ = other.myIsPPQ;
+    }
+
+    // The sample rate and tempo map used to convert the times of Control and Breakpoints automation to samples.
+    void setTiming(double sampleRate, std::shared_ptr<const TempoMap> tempoMap) {
+        mySampleRate = sampleRate;
+        myTempoMap = tempoMap;
+    }
+
+    // The automation with one value per sample, up to its last change.
     std::vector<float> getAutomation() {
-        return myAutomation;
+        if (myMode == AutomationMode::Samples) {
+            return myAutomation;
+        }
+
+        const size_t numSamples = getLastPointIndex() + 1;
+
+        std::vector<float> values(numSamples);
+        for (size_t i = 0; i < numSamples; i++) {
+            values[i] = sample(i);
+        }
+        return values;
+    }
+
+    // Whether the value can change during a render.
+    bool isAutomated() {
+        return myAutomation.size() > 1 || myBreakpoints.size() > 1;
+    }
+
+    // The index of the last sample at which the value may change, or 0 if it's constant.
+    size_t getLastChange() {
+        if (!isAutomated()) {
+            return 0;
+        }
+        if (myMode == AutomationMode::Samples) {
+            for (size_t i = myAutomation.size() - 1; i > 0; i--) {
+                if (myAutomation[i] != myAutomation[i - 1]) {
+                    return i;
+                }
+            }
+            return 0;
+        }
+        return getLastPointIndex();
+    }
+
+    // The first index in [from, to) at which the value differs from the previous index's, or to if there is none.
+    size_t findNextChange(size_t from, size_t to) {
+        from = std::max(from, (size_t)1);
+
+        if (myMode == AutomationMode::Samples) {
+            const size_t end = std::min(to, myAutomation.size());
+            for (size_t i = from; i < end; i++) {
+                if (myAutomation[i] != myAutomation[i - 1]) {
+                    return i;
+                }
+            }
+            return to;
+        }
+
+        float previous = sample(from - 1);
+        for (size_t i = from; i < to; i++) {
+            float value = sample(i);
+            if (value != previous) {
+                return i;
+            }
+            previous = value;
+        }
+        return to;
     }
 
     float sample(size_t index) {
+        switch (myMode)
+        {
+        case AutomationMode::Control:
+            return sampleControl(index);
+        case AutomationMode::Breakpoints:
+            return sampleBreakpoints(index);
+        default:
+            break;
+        }
+
         auto i = std::min(myAutomation.size() - 1, index);
         i = std::max((size_t)0, i);
         return myAutomation.at(i);
@@ -161,10 +313,67 @@ protected:
 
     std::vector<float> myAutomation;
 
+    AutomationMode myMode = AutomationMode::Samples;
+    std::vector<AutomationBreakpoint> myBreakpoints;
+    double myControlRate = 1.;
+    bool myIsPPQ = false;
+    double mySampleRate = 44100.;
+    std::shared_ptr<const TempoMap> myTempoMap = std::make_shared<TempoMap>();
+
     ~AutomateParameter()
     {
     }
 
+private:
+
+    // The index of the sample at the last control value or breakpoint.
+    size_t getLastPointIndex() {
+        double lastTime = 0.;
+        if (myMode == AutomationMode::Control) {
+            lastTime = (double)(myAutomation.size() - 1) / myControlRate;
+        }
+        else {
+            lastTime = myBreakpoints.back().time;
+        }
+        return (size_t)std::round((myIsPPQ ? myTempoMap->ppqToSeconds(lastTime) : lastTime) * mySampleRate);
+    }
+
+    // The time of a sample in seconds, or in quarter notes for PPQ automation.
+    double getTime(size_t index) {
+        const double seconds = (double)index / mySampleRate;
+        return myIsPPQ ? myTempoMap->secondsToPPQ(seconds) : seconds;
+    }
+
+    float sampleControl(size_t index) {
+        const double position = getTime(index) * myControlRate;
+        const size_t i = (size_t)position;
+        if (i + 1 >= myAutomation.size()) {
+            return myAutomation.back();
+        }
+        const float frac = (float)(position - (double)i);
+        return myAutomation[i] + frac * (myAutomation[i + 1] - myAutomation[i]);
+    }
+
+    float sampleBreakpoints(size_t index) {
+        const double time = getTime(index);
+
+        auto next = std::upper_bound(myBreakpoints.begin(), myBreakpoints.end(), time,
+            [](double t, const AutomationBreakpoint& breakpoint) { return t < breakpoint.time; });
+        if (next == myBreakpoints.begin()) {
+            return myBreakpoints.front().value;
+        }
+        if (next == myBreakpoints.end()) {
+            return myBreakpoints.back().value;
+        }
+
+        auto& previous = *(next - 1);
+        float t = (float)((time - previous.time) / (next->time - previous.time));
+        if (previous.curve != 0.f) {
+            t = std::expm1(previous.curve * t) / std::expm1(previous.curve);
+        }
+        return previous.value + t * (next->value - previous.value);
+    }
+
 };
 
 class AutomateParameterFloat : public AutomateParameter, public AudioParameterFloat {
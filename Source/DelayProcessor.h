@@ -14,6 +14,8 @@ public:
         myDelaySize = myParameters.getRawParameterValue("delay");
         myWetLevel = myParameters.getRawParameterValue("wet_level");
 
+        bindParameters({ "wet_level", "delay" });
+
     }
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) {
@@ -22,7 +24,7 @@ public:
 
         initDelay();
         
-        const int numChannels = 2;
+        const int numChannels = getTotalNumOutputChannels();
         juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32> (samplesPerBlock), static_cast<juce::uint32> (numChannels) };
         myDelay.prepare(spec);
     }
@@ -31,15 +33,18 @@ public:
 
         automateParameters();
 
-        delayBuffer.makeCopyOf(buffer);
+        const int numChannels = getTotalNumOutputChannels();
+        delayBuffer.setSize(numChannels, buffer.getNumSamples(), false, false, true);
+        for (int chan = 0; chan < numChannels; chan++) {
+            delayBuffer.copyFrom(chan, 0, buffer, chan, 0, buffer.getNumSamples());
+        }
         juce::dsp::AudioBlock<float> block(delayBuffer);
         juce::dsp::ProcessContextReplacing<float> context(block);
         myDelay.process(context);
 
-        buffer.applyGain(1.f - *myWetLevel);
-
-        for (int chan = 0; chan < buffer.getNumChannels(); chan++)
+        for (int chan = 0; chan < numChannels; chan++)
         {
+            buffer.applyGain(chan, 0, buffer.getNumSamples(), 1.f - *myWetLevel);
             buffer.addFrom(chan, 0, delayBuffer, chan, 0, buffer.getNumSamples(), *myWetLevel);
         }
         ProcessorBase::processBlock(buffer, midiBuffer);
@@ -50,8 +55,8 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        *myWetLevel = getAutomationVal("wet_level", posInfo.timeInSamples);
-        *myDelaySize = getAutomationVal("delay", posInfo.timeInSamples);
+        *myWetLevel = getBoundAutomationVal(WetLevel, posInfo.timeInSamples);
+        *myDelaySize = getBoundAutomationVal(Delay, posInfo.timeInSamples);
         updateParameters();
     }
 
@@ -61,6 +66,18 @@ public:
 
     const juce::String getName() { return "DelayProcessor"; };
 
+    double getTailLengthSeconds() const { return myDelaySize->load() * .001; }
+
+    bool canSkipWhenSilent() { return true; }
+
+    void clearTail() { reset(); }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new DelayProcessor(newUniqueName, myRule, getDelay(), getWet());
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
     void setDelay(float newDelaySize) { setAutomationVal("delay", newDelaySize); }
     float getDelay() { return getAutomationVal("delay", 0); }
 
@@ -70,6 +87,9 @@ public:
 
 private:
 
+    // The order of bindParameters.
+    enum BoundParameter { WetLevel, Delay };
+
     double mySampleRate = 44100.;
 
     std::atomic<float>* myDelaySize; // delay in milliseconds
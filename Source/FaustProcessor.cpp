@@ -2,7 +2,9 @@
 
 #ifdef BUILD_DAWDREAMER_FAUST
 
+#include <chrono>
 #include <filesystem>
+#include <limits>
 #include "faust/midi/RtMidi.cpp"
 
 #ifdef WIN32
@@ -11,7 +13,32 @@ __declspec(selectany) ztimedmap GUI::gTimedZoneMap;
 #else
 std::list<GUI*> GUI::fGuiList;
 ztimedmap GUI::gTimedZoneMap;
+
+#include <mutex>
+// GUI::fGuiList is shared by every FaustProcessor, which may be rendering on different threads.
+// It's recursive because failing to create an instance clears the processor while holding it.
+static std::recursive_mutex guiUpdateMutex;
+#endif
+
+// Holds guiUpdateMutex while GUI::fGuiList is used, which includes creating and deleting polyphonic instances,
+// since their voice groups add and remove themselves.
+class ScopedGuiLock
+{
+public:
+#ifdef WIN32
+	ScopedGuiLock(HANDLE mutex) : myMutex(mutex) {
+		// A thread that already owns the mutex doesn't wait. WAIT_ABANDONED still gives ownership.
+		WaitForSingleObject(myMutex, INFINITE);
+	}
+	~ScopedGuiLock() { ReleaseMutex(myMutex); }
+private:
+	HANDLE myMutex;
+#else
+	ScopedGuiLock(std::recursive_mutex& mutex) : myLock(mutex) {}
+private:
+	std::lock_guard<std::recursive_mutex> myLock;
 #endif
+};
 
 #ifndef SAFE_DELETE
 #define SAFE_DELETE(x)              do { if(x){ delete x; x = NULL; } } while(0)
@@ -27,8 +54,6 @@ FaustProcessor::FaustProcessor(std::string newUniqueName, double sampleRate, int
 {
 	mySampleRate = sampleRate;
 
-	m_factory = NULL;
-	m_poly_factory = NULL;
 	m_dsp = NULL;
 	m_dsp_poly = NULL;
 	m_ui = NULL;
@@ -45,13 +70,53 @@ FaustProcessor::FaustProcessor(std::string newUniqueName, double sampleRate, int
 }
 
 FaustProcessor::~FaustProcessor() {
+	waitForCompile();
+	// Only release this processor's factories. Other processors, such as clones, may be using the same code.
 	clear();
-	deleteAllDSPFactories();
+}
+
+ProcessorBase*
+FaustProcessor::clone(std::string newUniqueName)
+{
+	auto processor = new FaustProcessor(newUniqueName, mySampleRate, getBlockSize());
+
+	processor->m_autoImport = m_autoImport;
+	processor->m_code = m_code;
+	processor->m_compileFlags = m_compileFlags;
+	processor->m_target = m_target;
+	processor->m_nvoices = m_nvoices;
+	processor->m_groupVoices = m_groupVoices;
+	processor->m_SoundfileMap = m_SoundfileMap;
+	processor->myMidiBuffer = myMidiBuffer;
+	processor->myMidiSequenceQN = myMidiSequenceQN;
+
+	// Share the compiled factory and only make a new DSP instance. Otherwise compile now rather than on whichever
+	// thread first renders the clone.
+	bool success = true;
+	if (m_isCompiled) {
+		processor->m_factory = m_factory;
+		processor->m_poly_factory = m_poly_factory;
+		success = processor->createInstance();
+	}
+	else if (!m_code.empty()) {
+		success = processor->compile();
+	}
+	if (!success) {
+		delete processor;
+		return nullptr;
+	}
+	processor->copyAutomationFrom(*this);
+
+	return processor;
 }
 
 void
 FaustProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+	if (m_isCompiled && std::max(getTotalNumInputChannels(), getTotalNumOutputChannels()) < std::max(m_numInputChannels, m_numOutputChannels)) {
+		std::cerr << "Warning: " << getUniqueName() << " has " << m_numInputChannels << " inputs and " << m_numOutputChannels <<
+			" outputs, but the graph gives it fewer channels. Declare its number of channels in load_graph. It will output silence." << std::endl;
+	}
 }
 
 void
@@ -67,48 +132,56 @@ FaustProcessor::processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&
 		return;
 	}
 
+	if (buffer.getNumChannels() < std::max(m_numInputChannels, m_numOutputChannels)) {
+		// The graph gave the processor fewer channels than the DSP reads or writes.
+		buffer.clear();
+		ProcessorBase::processBlock(buffer, midiBuffer);
+		return;
+	}
+
 	if (m_nvoices < 1) {
 		if (m_dsp != NULL) {
 			m_dsp->compute(buffer.getNumSamples(), (float**)buffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers());
 		}
 	}
 	else if (m_dsp_poly != NULL) {
-		long long int start = posInfo.timeInSamples;
-
-		// render one sample at a time
-
-		for (size_t i = 0; i < buffer.getNumSamples(); i++)
-		{
-			myIsMessageBetween = myMidiMessagePosition >= start && myMidiMessagePosition < start + 1;
-			do {
-				if (myIsMessageBetween) {
-
-					int midiChannel = 0;
-					if (myMidiMessage.isNoteOn()) {
-						m_dsp_poly->keyOn(midiChannel, myMidiMessage.getNoteNumber(), myMidiMessage.getVelocity());
-					}
-					else {
-						m_dsp_poly->keyOff(midiChannel, myMidiMessage.getNoteNumber(), myMidiMessage.getVelocity());
-					}
-					
-					myMidiEventsDoRemain = myMidiIterator->getNextEvent(myMidiMessage, myMidiMessagePosition);
-					myIsMessageBetween = myMidiMessagePosition >= start && myMidiMessagePosition < start + 1;
+		const long long int start = posInfo.timeInSamples;
+		const int numSamples = buffer.getNumSamples();
+
+		// Render the samples between MIDI events in one call, so that notes start and stop on the right sample.
+		// The DSP reads its inputs before it writes its outputs, so it can compute the buffer in place.
+		int offset = 0;
+		while (offset < numSamples) {
+
+			while (myMidiEventsDoRemain && myMidiMessagePosition < start + offset + 1) {
+				int midiChannel = 0;
+				if (myMidiMessage.isNoteOn()) {
+					m_dsp_poly->keyOn(midiChannel, myMidiMessage.getNoteNumber(), myMidiMessage.getVelocity());
+				}
+				else {
+					m_dsp_poly->keyOff(midiChannel, myMidiMessage.getNoteNumber(), myMidiMessage.getVelocity());
 				}
-			} while (myIsMessageBetween && myMidiEventsDoRemain);
 
-			for (size_t chan = 0; chan < m_numInputChannels; chan++)
-			{
-				oneSampleInBuffer.setSample(chan, 0, buffer.getSample(chan, i));
+				myMidiEventsDoRemain = myMidiIterator->getNextEvent(myMidiMessage, myMidiMessagePosition);
 			}
 
-			m_dsp_poly->compute(1, (float**) oneSampleInBuffer.getArrayOfReadPointers(), (float**) oneSampleOutBuffer.getArrayOfWritePointers());
+			// Stop at the next event, and at the size of the buffers in which mydsp_poly mixes its voices.
+			int subBlockEnd = numSamples;
+			if (myMidiEventsDoRemain && myMidiMessagePosition < start + numSamples) {
+				subBlockEnd = (int)(myMidiMessagePosition - start);
+			}
+			const int subBlockSize = std::min(subBlockEnd - offset, MIX_BUFFER_SIZE);
 
-			for (size_t chan = 0; chan < m_numOutputChannels; chan++)
-			{
-				buffer.setSample(chan, i, oneSampleOutBuffer.getSample(chan, 0));
+			for (int chan = 0; chan < m_numInputChannels; chan++) {
+				myPolyInputs[chan] = buffer.getWritePointer(chan) + offset;
 			}
+			for (int chan = 0; chan < m_numOutputChannels; chan++) {
+				myPolyOutputs[chan] = buffer.getWritePointer(chan) + offset;
+			}
+
+			m_dsp_poly->compute(subBlockSize, myPolyInputs.data(), myPolyOutputs.data());
 
-			start += 1;
+			offset += subBlockSize;
 		}
 	}
 
@@ -157,36 +230,27 @@ FaustProcessor::automateParameters() {
 
 	// If polyphony is enabled and we're grouping voices,
 	// several voices might share the same parameters in a group.
-	// Therefore we have to call updateAllGuis to update all dependent parameters.
+	// Therefore we have to update the zones of the group to update all dependent parameters.
+	// Only this instance's group is updated, because GUI::updateAllGuis() would write to the voices
+	// of other FaustProcessors, which may be rendering on other threads.
 	if (m_nvoices > 0 && m_groupVoices) {
-#ifdef WIN32
-		// When you want to access shared memory:
-		DWORD dwWaitResult = WaitForSingleObject(guiUpdateMutex, INFINITE);
-
-		if (dwWaitResult == WAIT_OBJECT_0 || dwWaitResult == WAIT_ABANDONED)
-		{
-			if (dwWaitResult == WAIT_ABANDONED)
-			{
-				// todo:
-				// Shared memory is maybe in inconsistent state because other program
-				// crashed while holding the mutex. Check the memory for consistency
-			}
-
-			// Have Faust update all GUIs.
-			GUI::updateAllGuis();
-
-			// After this line other processes can access shared memory
-			ReleaseMutex(guiUpdateMutex);
+		if (auto voiceGroup = dynamic_cast<dsp_voice_group*>(m_dsp_poly)) {
+			voiceGroup->fGroups.updateAllZones();
 		}
-#else
-		GUI::updateAllGuis(); // todo: enable mutex on linux and macOS
-#endif
 	}
 }
 
+long long int
+FaustProcessor::getLastEventSample()
+{
+	return std::max(ProcessorBase::getLastEventSample(), (long long int)myMergedMidiBuffer.getLastEventTime());
+}
+
 void
 FaustProcessor::reset()
 {
+	waitForCompile();
+
 	if (m_dsp) {
 		m_dsp->instanceClear();
 	}
@@ -199,7 +263,8 @@ FaustProcessor::reset()
 		delete myMidiIterator;
 	}
 
-	myMidiIterator = new MidiBuffer::Iterator(myMidiBuffer); // todo: deprecated.
+	mergeMidi(myMidiBuffer, myMidiSequenceQN, myMergedMidiBuffer);
+	myMidiIterator = new MidiBuffer::Iterator(myMergedMidiBuffer); // todo: deprecated.
 	myMidiEventsDoRemain = myMidiIterator->getNextEvent(myMidiMessage, myMidiMessagePosition);
 
 	if (!m_isCompiled) {
@@ -210,6 +275,8 @@ FaustProcessor::reset()
 void
 FaustProcessor::clear()
 {
+	ScopedGuiLock lock(guiUpdateMutex);
+
 	m_isCompiled = false;
 	m_numInputChannels = 0;
 	m_numOutputChannels = 0;
@@ -225,8 +292,9 @@ FaustProcessor::clear()
 	SAFE_DELETE(m_ui);
 	SAFE_DELETE(m_dsp_poly);
 
-	m_factory = NULL;
-	m_poly_factory = NULL;
+	// The factories are shared with the cache and with other processors.
+	m_factory.reset();
+	m_poly_factory.reset();
 }
 
 void
@@ -267,78 +335,362 @@ FaustProcessor::setDSPString(const std::string& code)
 	return true;
 }
 
+std::mutex FaustFactoryCache::myMutex;
+std::string FaustFactoryCache::myCacheDirectory;
+std::map<std::string, std::shared_future<std::shared_ptr<llvm_dsp_factory>>> FaustFactoryCache::myFactories;
+std::map<std::string, std::shared_future<std::shared_ptr<llvm_dsp_poly_factory>>> FaustFactoryCache::myPolyFactories;
+
+// Find the factory with the given key in memory, then on disk, and compile it only if it's in neither. If another
+// thread is already compiling the same factory, wait for it instead of compiling it again.
+template <typename Factory>
+static std::shared_ptr<Factory>
+getCachedFactory(std::mutex& mutex, std::map<std::string, std::shared_future<std::shared_ptr<Factory>>>& factories, const std::string& key,
+	std::function<std::string()> getCachePath, std::function<Factory* (const std::string&)> read, std::function<Factory* ()> create,
+	std::function<bool(Factory*, const std::string&)> write, std::function<void(Factory*)> release, std::string& errorMessage)
+{
+	std::shared_future<std::shared_ptr<Factory>> cachedFactory;
+	std::promise<std::shared_ptr<Factory>> promise;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = factories.find(key);
+		if (it != factories.end()) {
+			cachedFactory = it->second;
+		}
+		else {
+			factories[key] = promise.get_future().share();
+		}
+	}
+
+	if (cachedFactory.valid()) {
+		auto sharedFactory = cachedFactory.get();
+		if (!sharedFactory) {
+			errorMessage = "The same code failed to compile for another FaustProcessor.";
+		}
+		return sharedFactory;
+	}
+
+	// Compile without holding the lock, so that different DSPs can compile at the same time. Errors are caught here,
+	// so that the threads waiting for this factory get nullptr and the key is erased below.
+	Factory* factory = nullptr;
+	bool isCreated = false;
+	std::string cachePath;
+	try {
+		cachePath = getCachePath();
+		std::error_code error;
+		if (!cachePath.empty() && std::filesystem::exists(cachePath, error)) {
+			factory = read(cachePath);
+		}
+		if (!factory) {
+			factory = create();
+			isCreated = factory != nullptr;
+		}
+	}
+	catch (std::exception& e) {
+		errorMessage = e.what();
+	}
+	catch (...) {
+		errorMessage = "Unknown error while compiling the Faust code.";
+	}
+
+	if (isCreated && !cachePath.empty()) {
+		// Write to a temporary file and move it into place, so that other processes never read half a file.
+		// The file only saves time, so failing to write it doesn't fail the compile.
+		const auto temporaryPath = cachePath + "." + juce::Uuid().toString().toStdString() + ".tmp";
+		std::error_code error;
+		try {
+			if (write(factory, temporaryPath)) {
+				std::filesystem::rename(temporaryPath, cachePath, error);
+			}
+		}
+		catch (...) {
+		}
+		std::filesystem::remove(temporaryPath, error);
+	}
+
+	std::shared_ptr<Factory> sharedFactory;
+	if (factory) {
+		sharedFactory = std::shared_ptr<Factory>(factory, release);
+	}
+	else {
+		// Let the next processor with this code try again.
+		std::lock_guard<std::mutex> lock(mutex);
+		factories.erase(key);
+	}
+
+	promise.set_value(sharedFactory);
+	return sharedFactory;
+}
+
+static std::vector<const char*>
+makeArgv(const std::vector<std::string>& args)
+{
+	std::vector<const char*> argv;
+	for (auto& arg : args) {
+		argv.push_back(arg.c_str());
+	}
+	return argv;
+}
+
+std::shared_ptr<llvm_dsp_factory>
+FaustFactoryCache::getFactory(const std::string& code, const std::vector<std::string>& args, const std::string& target, std::string& errorMessage)
+{
+	return getCachedFactory<llvm_dsp_factory>(myMutex, myFactories, makeKey(false, code, args, target),
+		[&]() { return getCachePath(false, code, args, target); },
+		[&](const std::string& path) {
+			std::string readError;
+			return readDSPFactoryFromMachineFile(path, target, readError);
+		},
+		[&]() {
+			auto argv = makeArgv(args);
+			return createDSPFactoryFromString("DawDreamer", code, (int)argv.size(), argv.data(), target, errorMessage, -1);
+		},
+		[&](llvm_dsp_factory* factory, const std::string& path) { return writeDSPFactoryToMachineFile(factory, path, target); },
+		[](llvm_dsp_factory* factory) { deleteDSPFactory(factory); }, errorMessage);
+}
+
+std::shared_ptr<llvm_dsp_poly_factory>
+FaustFactoryCache::getPolyFactory(const std::string& code, const std::vector<std::string>& args, const std::string& target, std::string& errorMessage)
+{
+	return getCachedFactory<llvm_dsp_poly_factory>(myMutex, myPolyFactories, makeKey(true, code, args, target),
+		[&]() { return getCachePath(true, code, args, target); },
+		[&](const std::string& path) {
+			std::string readError;
+			return readPolyDSPFactoryFromMachineFile(path, target, readError);
+		},
+		[&]() {
+			auto argv = makeArgv(args);
+			return createPolyDSPFactoryFromString("DawDreamer", code, (int)argv.size(), argv.data(), target, errorMessage, -1);
+		},
+		[&](llvm_dsp_poly_factory* factory, const std::string& path) { return writePolyDSPFactoryToMachineFile(factory, path, target); },
+		[](llvm_dsp_poly_factory* factory) { delete factory; }, errorMessage);
+}
+
+std::string
+FaustFactoryCache::makeKey(bool polyphonic, const std::string& code, const std::vector<std::string>& args, const std::string& target)
+{
+	// The voice count and grouping only affect the DSP instances, so every polyphonic configuration shares a factory.
+	std::string data = polyphonic ? "poly\n" : "mono\n";
+	data += (target.empty() ? getDSPMachineTarget() : target) + "\n";
+	for (auto& arg : args) {
+		data += arg + "\n";
+	}
+	data += code;
+
+	return juce::SHA256(data.data(), data.size()).toHexString().toStdString();
+}
+
+std::string
+FaustFactoryCache::getCachePath(bool polyphonic, const std::string& code, const std::vector<std::string>& args, const std::string& target)
+{
+	const auto cacheDirectory = getCacheDirectory();
+	if (cacheDirectory.empty()) {
+		return "";
+	}
+
+	// Key the file by the code with every import expanded, so that editing a library doesn't load stale machine code.
+	// Faust only parses the code for this, which takes a small part of the time that LLVM does.
+	auto argv = makeArgv(args);
+	std::string shaKey;
+	std::string errorMessage;
+	expandDSPFromString("DawDreamer", code, (int)argv.size(), argv.data(), shaKey, errorMessage);
+	if (shaKey.empty()) {
+		return "";
+	}
+
+	const auto key = makeKey(polyphonic, shaKey, args, target);
+	return (std::filesystem::path(cacheDirectory) / (key + ".fbc")).string();
+}
+
+bool
+FaustFactoryCache::setCacheDirectory(const std::string& path)
+{
+	if (!path.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(path, error);
+		if (error) {
+			std::cerr << "Error: can't create the Faust cache directory " << path << ": " << error.message() << std::endl;
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(myMutex);
+	myCacheDirectory = path;
+	return true;
+}
+
+std::string
+FaustFactoryCache::getCacheDirectory()
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	return myCacheDirectory;
+}
+
+void
+FaustFactoryCache::clear()
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	myFactories.clear();
+	myPolyFactories.clear();
+}
+
 #define FAUSTPROCESSOR_FAIL_COMPILE clear(); return false;
 
 bool
 FaustProcessor::compile()
 {
-	m_isCompiled = false;
+	waitForCompile();
+	return compileNow();
+}
 
-	// clean up
-	clear();
+std::shared_future<bool>
+FaustProcessor::compileAsync()
+{
+	waitForCompile();
+	m_compileFuture = std::async(std::launch::async, [this]() { return compileNow(); }).share();
+	return m_compileFuture;
+}
 
-	// optimization level
-	const int optimize = -1;
-	// arguments
+void
+FaustProcessor::waitForCompile()
+{
+	if (m_compileFuture.valid()) {
+		m_compileFuture.wait();
+	}
+}
 
-	auto pathToFaustLibraries = getPathToFaustLibraries();
+bool
+FaustProcessor::compileNow()
+{
+	return compileWithFactories(getFactories());
+}
 
-	int argc = 0;
-	const char** argv = NULL;
-	if (pathToFaustLibraries.compare(std::string("")) != 0) {
-		argc = 2;
-		argv = new const char* [argc];
-		argv[0] = "-I";
-		argv[1] = pathToFaustLibraries.c_str();
-	}
+FaustFactories
+FaustProcessor::getFactories()
+{
+	auto args = getCompileArgs(m_compileFlags);
 
 	auto theCode = m_autoImport + "\n" + m_code;
 
-	std::string m_errorString;
-
-	// create new factory
+	// get the factory, which is only compiled if it isn't cached
+	FaustFactories factories;
 	bool is_polyphonic = m_nvoices > 0;
 	if (is_polyphonic) {
-		m_poly_factory = createPolyDSPFactoryFromString("DawDreamer", theCode,
-			argc, argv, "", m_errorString, optimize);
+		factories.polyFactory = FaustFactoryCache::getPolyFactory(theCode, args, m_target, factories.errorMessage);
 	}
 	else {
-		m_factory = createDSPFactoryFromString("DawDreamer", theCode,
-			argc, argv, "", m_errorString, optimize);
+		factories.factory = FaustFactoryCache::getFactory(theCode, args, m_target, factories.errorMessage);
 	}
 
+	return factories;
+}
+
+bool
+FaustProcessor::compileWithFactories(const FaustFactories& factories)
+{
+	m_isCompiled = false;
+
+	// clean up
+	clear();
+
+	m_factory = factories.factory;
+	m_poly_factory = factories.polyFactory;
+
 	// check for error
-	if (m_errorString != "") {
+	if (factories.errorMessage != "" || (!m_factory && !m_poly_factory)) {
 		// output error
-		std::cerr << "FaustProcessor::compile(): " << m_errorString << std::endl;
-		std::cerr << "Check the faustlibraries path: " << pathToFaustLibraries.c_str() << std::endl;
+		std::cerr << "FaustProcessor::compile(): " << factories.errorMessage << std::endl;
+		std::cerr << "Check the faustlibraries path: " << getPathToFaustLibraries().c_str() << std::endl;
 		FAUSTPROCESSOR_FAIL_COMPILE
 	}
 
-    //// print where faustlib is looking for stdfaust.lib and the other lib files.
-    //auto pathnames = m_factory->getIncludePathnames();
-    //std::cout << "pathnames:\n" << std::endl;
-    //for (auto name : pathnames) {
-    //    std::cout << name << "\n" << std::endl;
-    //}
-    //std::cout << "library list:\n" << std::endl;
-    //auto librarylist = m_factory->getLibraryList();
-    //for (auto name : librarylist) {
-    //    std::cout << name << "\n" << std::endl;
-    //}
-
-	if (argv) {
-		for (int i = 0; i < argc; i++) {
-			argv[i] = NULL;
+	return createInstance();
+}
+
+std::vector<std::string>
+FaustProcessor::getCompileArgs(const std::vector<std::string>& flags)
+{
+	std::vector<std::string> args = flags;
+
+	auto pathToFaustLibraries = getPathToFaustLibraries();
+	if (pathToFaustLibraries.compare(std::string("")) != 0) {
+		args.push_back("-I");
+		args.push_back(pathToFaustLibraries);
+	}
+
+	return args;
+}
+
+void
+FaustProcessor::setCompileFlags(const std::vector<std::string>& flags)
+{
+	m_isCompiled = false;
+	m_compileFlags = flags;
+}
+
+void
+FaustProcessor::setTarget(const std::string& target)
+{
+	m_isCompiled = false;
+	m_target = target;
+}
+
+std::vector<double>
+FaustProcessor::benchmarkCompileFlags(const std::vector<std::vector<std::string>>& flagSets, double duration, int blockSize)
+{
+	std::vector<double> times;
+
+	auto theCode = m_autoImport + "\n" + m_code;
+	const long long int numSamples = (long long int)(duration * mySampleRate);
+	blockSize = std::max(1, blockSize);
+
+	for (auto& flags : flagSets) {
+
+		// Polyphonic instruments are timed as one voice.
+		std::string errorString;
+		auto factory = FaustFactoryCache::getFactory(theCode, getCompileArgs(flags), m_target, errorString);
+		std::unique_ptr<dsp> theDsp(factory ? factory->createDSPInstance() : nullptr);
+		if (!theDsp) {
+			std::cerr << "FaustProcessor::benchmarkCompileFlags(): " << errorString << std::endl;
+			times.push_back(std::numeric_limits<double>::infinity());
+			continue;
 		}
-		argv = NULL;
+
+		MySoundUI soundUI;
+		for (const auto& [label, buffers] : m_SoundfileMap) {
+			soundUI.addSoundfileFromBuffers(label.c_str(), buffers, (int)(mySampleRate + .5));
+		}
+		theDsp->buildUserInterface(&soundUI);
+		theDsp->init((int)(mySampleRate + .5));
+
+		juce::AudioSampleBuffer inputs(std::max(1, theDsp->getNumInputs()), blockSize);
+		juce::AudioSampleBuffer outputs(std::max(1, theDsp->getNumOutputs()), blockSize);
+		inputs.clear();
+
+		// The first block is left out of the time, since it may touch memory for the first time.
+		theDsp->compute(blockSize, (float**)inputs.getArrayOfReadPointers(), outputs.getArrayOfWritePointers());
+
+		auto start = std::chrono::steady_clock::now();
+		for (long long int sample = 0; sample < numSamples; sample += blockSize) {
+			const int count = (int)std::min((long long int)blockSize, numSamples - sample);
+			theDsp->compute(count, (float**)inputs.getArrayOfReadPointers(), outputs.getArrayOfWritePointers());
+		}
+		times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 	}
 
+	return times;
+}
+
+bool
+FaustProcessor::createInstance()
+{
+	ScopedGuiLock lock(guiUpdateMutex);
+
+	bool is_polyphonic = m_nvoices > 0;
 	if (is_polyphonic) {
 		// (false, true) works
 		m_dsp_poly = m_poly_factory->createPolyDSPInstance(m_nvoices, true, m_groupVoices);
 		if (!m_dsp_poly) {
-			std::cerr << "FaustProcessor::compile(): Cannot create instance." << std::endl;
+			std::cerr << "FaustProcessor::createInstance(): Cannot create instance." << std::endl;
 			FAUSTPROCESSOR_FAIL_COMPILE
 		}
 	}
@@ -346,7 +698,7 @@ FaustProcessor::compile()
 		// create DSP instance
 		m_dsp = m_factory->createDSPInstance();
 		if (!m_dsp) {
-			std::cerr << "FaustProcessor::compile(): Cannot create instance." << std::endl;
+			std::cerr << "FaustProcessor::createInstance(): Cannot create instance." << std::endl;
 			FAUSTPROCESSOR_FAIL_COMPILE
 		}
 	}
@@ -357,11 +709,6 @@ FaustProcessor::compile()
 	int inputs = theDsp->getNumInputs();
 	int outputs = theDsp->getNumOutputs();
 
-	if (outputs != 2) {
-		std::cerr << "FaustProcessor::compile(): FaustProcessor must have DSP code with 2 output channels but was compiled for " << m_numOutputChannels << "." << std::endl;
-		FAUSTPROCESSOR_FAIL_COMPILE
-	}
-
 	m_numInputChannels = inputs;
 	m_numOutputChannels = outputs;
 
@@ -371,8 +718,8 @@ FaustProcessor::compile()
 		m_midi_handler = rt_midi("my_midi");
 		m_midi_handler.addMidiIn(m_dsp_poly);
 
-		oneSampleInBuffer.setSize(m_numInputChannels, 1);
-		oneSampleOutBuffer.setSize(m_numOutputChannels, 1);
+		myPolyInputs.resize(m_numInputChannels);
+		myPolyOutputs.resize(m_numOutputChannels);
 	}
 
 	m_ui = new APIUI();
@@ -603,41 +950,28 @@ FaustProcessor::getPluginParametersDescription()
 int
 FaustProcessor::getNumMidiEvents()
 {
-	return myMidiBuffer.getNumEvents();
+	return myMidiBuffer.getNumEvents() + myMidiSequenceQN.getNumEvents();
 };
 
 bool
-FaustProcessor::loadMidi(const std::string& path)
+FaustProcessor::loadMidi(const std::string& path, bool beats)
 {
-	File file = File(path);
-	FileInputStream fileStream(file);
-	MidiFile midiFile;
-	midiFile.readFrom(fileStream);
-	midiFile.convertTimestampTicksToSeconds();
-	myMidiBuffer.clear();
-
-	for (int t = 0; t < midiFile.getNumTracks(); t++) {
-		const MidiMessageSequence* track = midiFile.getTrack(t);
-		for (int i = 0; i < track->getNumEvents(); i++) {
-			MidiMessage& m = track->getEventPointer(i)->message;
-			int sampleOffset = (int)(mySampleRate * m.getTimeStamp());
-			myMidiBuffer.addEvent(m, sampleOffset);
-		}
-	}
-
-	return true;
+	clearMidi();
+	return readMidiFile(path, beats, mySampleRate, myMidiBuffer, myMidiSequenceQN);
 }
 
 void
 FaustProcessor::clearMidi() {
 	myMidiBuffer.clear();
+	myMidiSequenceQN.clear();
 }
 
 bool
 FaustProcessor::addMidiNote(uint8  midiNote,
 	uint8  midiVelocity,
 	const double noteStart,
-	const double noteLength) {
+	const double noteLength,
+	bool beats) {
 
 	if (midiNote > 255) midiNote = 255;
 	if (midiNote < 0) midiNote = 0;
@@ -656,6 +990,14 @@ FaustProcessor::addMidiNote(uint8  midiNote,
 		midiNote,
 		midiVelocity);
 
+	if (beats) {
+		onMessage.setTimeStamp(noteStart);
+		offMessage.setTimeStamp(noteStart + noteLength);
+		myMidiSequenceQN.addEvent(onMessage);
+		myMidiSequenceQN.addEvent(offMessage);
+		return true;
+	}
+
 	auto startTime = noteStart * mySampleRate;
 	onMessage.setTimeStamp(startTime);
 	offMessage.setTimeStamp(startTime + noteLength * mySampleRate);
@@ -15,6 +15,9 @@
 
 #include <iostream>
 #include <map>
+#include <future>
+#include <memory>
+#include <mutex>
 
 
 class MySoundUI : public SoundUI {
@@ -96,6 +99,51 @@ public:
 };
 
 
+// The compiled Faust factories of this process, keyed by a hash of the code, the compile arguments and the LLVM
+// target, so that compiling the same DSP again doesn't run Faust and LLVM. Every FaustProcessor with the same code
+// and options shares one factory and only has its own DSP instance. If a cache directory is set, factories
+// are also saved there as machine code, and other processes load them instead of compiling them. The files are keyed
+// by the code with its imports expanded, so they follow edits to the libraries. The factories in memory don't, so
+// clear() them after editing a library.
+class FaustFactoryCache
+{
+public:
+    // Return the factory of code, compiling it if it isn't cached. Returns nullptr and sets errorMessage on failure.
+    static std::shared_ptr<llvm_dsp_factory> getFactory(const std::string& code, const std::vector<std::string>& args,
+        const std::string& target, std::string& errorMessage);
+    static std::shared_ptr<llvm_dsp_poly_factory> getPolyFactory(const std::string& code, const std::vector<std::string>& args,
+        const std::string& target, std::string& errorMessage);
+
+    // An empty path disables the cache on disk.
+    static bool setCacheDirectory(const std::string& path);
+    static std::string getCacheDirectory();
+
+    // Forget the factories in memory. Processors that use them keep them until they're cleared.
+    static void clear();
+
+private:
+    static std::mutex myMutex;
+    static std::string myCacheDirectory;
+    // The factories that are compiled or being compiled.
+    static std::map<std::string, std::shared_future<std::shared_ptr<llvm_dsp_factory>>> myFactories;
+    static std::map<std::string, std::shared_future<std::shared_ptr<llvm_dsp_poly_factory>>> myPolyFactories;
+
+    static std::string makeKey(bool polyphonic, const std::string& code, const std::vector<std::string>& args, const std::string& target);
+
+    // The file of the factory in the cache directory, or an empty string if there's no cache directory.
+    static std::string getCachePath(bool polyphonic, const std::string& code, const std::vector<std::string>& args, const std::string& target);
+};
+
+// The factory that FaustProcessor::getFactories() found or compiled, which is polyFactory for polyphonic processors.
+class FaustFactories
+{
+public:
+    std::shared_ptr<llvm_dsp_factory> factory;
+    std::shared_ptr<llvm_dsp_poly_factory> polyFactory;
+    std::string errorMessage;
+};
+
+
 class FaustProcessor : public ProcessorBase
 {
 public:
@@ -115,9 +163,22 @@ public:
 
     const juce::String getName() const { return "FaustProcessor"; }
 
+    ProcessorBase* clone(std::string newUniqueName);
+
+    long long int getLastEventSample();
+
     // faust stuff
     void clear();
     bool compile();
+    // Compile on another thread. Don't use the processor until the future is ready, but it can be destroyed at any time.
+    std::shared_future<bool> compileAsync();
+    // Get the factory of the code from the cache, compiling it if needed. This doesn't change the processor,
+    // so several processors can get their factories on different threads at once.
+    FaustFactories getFactories();
+    // Make the DSP instance, its UI and its parameters from the factory. Returns false on failure.
+    bool compileWithFactories(const FaustFactories& factories);
+    // Wait for the compile started by compileAsync, if any.
+    void waitForCompile();
     bool setDSPString(const std::string& code);
     bool setDSPFile(const std::string& path);
     bool setParamWithIndex(const int index, float p);
@@ -137,7 +198,19 @@ public:
     void setAutoImport(const std::string& s) { m_autoImport = s; }
     std::string getAutoImport() { return m_autoImport; }
 
-    bool loadMidi(const std::string& path);
+    // Flags for the Faust compiler, such as {"-vec", "-vs", "32"}, which are passed along with the path to the libraries.
+    void setCompileFlags(const std::vector<std::string>& flags);
+    std::vector<std::string> getCompileFlags() { return m_compileFlags; }
+
+    // The LLVM target as "triple:cpu", for example "x86_64-pc-linux-gnu:skylake-avx512". An empty target is the host.
+    void setTarget(const std::string& target);
+    std::string getTarget() { return m_target; }
+
+    // Compile the code with each set of flags and time how long the DSP takes to render duration seconds of audio
+    // in blocks of blockSize samples. Returns the times in seconds, which are infinite for flags that don't compile.
+    std::vector<double> benchmarkCompileFlags(const std::vector<std::vector<std::string>>& flagSets, double duration, int blockSize);
+
+    bool loadMidi(const std::string& path, bool beats);
 
     void clearMidi();
 
@@ -146,7 +219,8 @@ public:
     bool addMidiNote(const uint8  midiNote,
         const uint8  midiVelocity,
         const double noteStart,
-        const double noteLength);
+        const double noteLength,
+        bool beats);
 
     void setSoundfiles(py::dict);
 
@@ -160,13 +234,23 @@ private:
 
     std::string getPathToFaustLibraries();
 
+    // The compile flags followed by the include path of the Faust libraries.
+    std::vector<std::string> getCompileArgs(const std::vector<std::string>& flags);
+
+    // Make the DSP instance, its UI and its parameters from the factory.
+    bool createInstance();
+
+    bool compileNow();
+
+    std::shared_future<bool> m_compileFuture;
+
 protected:
 
-    llvm_dsp_factory* m_factory;
+    std::shared_ptr<llvm_dsp_factory> m_factory;
     dsp* m_dsp;
     APIUI* m_ui;
 
-    llvm_dsp_poly_factory* m_poly_factory = nullptr;
+    std::shared_ptr<llvm_dsp_poly_factory> m_poly_factory;
     dsp_poly* m_dsp_poly = nullptr;
     MySoundUI* m_soundUI = nullptr;
 
@@ -177,20 +261,25 @@ protected:
 
     std::string m_autoImport;
     std::string m_code;
+    std::vector<std::string> m_compileFlags;
+    std::string m_target;
 
     int m_nvoices = 0;    
     bool m_groupVoices = true;
     bool m_isCompiled = false;
 
     MidiBuffer myMidiBuffer;
+    // MIDI timed in quarter notes, and all of the MIDI timed in samples for the current render.
+    MidiMessageSequence myMidiSequenceQN;
+    MidiBuffer myMergedMidiBuffer;
     MidiMessage myMidiMessage;
     int myMidiMessagePosition = -1;
     MidiBuffer::Iterator* myMidiIterator = nullptr;
-    bool myIsMessageBetween = false;
     bool myMidiEventsDoRemain = false;
 
-    juce::AudioSampleBuffer oneSampleInBuffer;
-    juce::AudioSampleBuffer oneSampleOutBuffer;
+    // The channels of the polyphonic DSP's inputs and outputs from the start of the current sub-block.
+    std::vector<float*> myPolyInputs;
+    std::vector<float*> myPolyOutputs;
 
     std::map<int, int> m_map_juceIndex_to_faustIndex;
     std::map<int, std::string> m_map_juceIndex_to_parAddress;
@@ -12,22 +12,34 @@ FilterProcessor::FilterProcessor(std::string newUniqueName, std::string mode, fl
     myQ = myParameters.getRawParameterValue("q");
     myGain = myParameters.getRawParameterValue("gain");
 
+    bindParameters({ "freq", "q", "gain" });
+
     setMode(mode);
 }
 
 const juce::String FilterProcessor::getName() { return "FilterProcessor"; }
 
+ProcessorBase*
+FilterProcessor::clone(std::string newUniqueName)
+{
+    auto processor = new FilterProcessor(newUniqueName, getMode(), getFrequency(), getQ(), getGain());
+    processor->setSmoothing(mySmoothing);
+    processor->copyAutomationFrom(*this);
+    return processor;
+}
+
 void
 FilterProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     mySampleRate = sampleRate;
     mySamplesPerBlock = samplesPerBlock;
 
-    automateParameters();  // this gives the filters an initial state.
+    // The sample rate may have changed, so compute the coefficients again.
+    myHasCoefficients = false;
+    automateParameters();
 
-    int numChannels = 2;
-    juce::dsp::ProcessSpec spec{ mySampleRate, static_cast<juce::uint32> (mySamplesPerBlock), static_cast<juce::uint32> (numChannels) };
-    myFilter.prepare(spec);  // todo: need to do this?
+    const int numChannels = getTotalNumOutputChannels();
+    myLaneStates.assign((size_t)((numChannels + numLanes - 1) / numLanes), LaneState());
 }
 
 void
@@ -35,56 +47,211 @@ FilterProcessor::processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&
 {
     automateParameters();
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    myFilter.process(context);
+    const int numChannels = std::min(getTotalNumOutputChannels(), buffer.getNumChannels());
+    const int numGroups = (numChannels + numLanes - 1) / numLanes;
+    if ((int)myLaneStates.size() < numGroups) {
+        myLaneStates.resize((size_t)numGroups);
+    }
+
+    float* const* channels = buffer.getArrayOfWritePointers();
+    for (int group = 0; group < numGroups; group++) {
+        const int firstChannel = group * numLanes;
+        processLanes(channels + firstChannel, std::min(numLanes, numChannels - firstChannel), buffer.getNumSamples(), myLaneStates[group]);
+    }
+
+    myPreviousCoefficients = myCoefficients;
+
     ProcessorBase::processBlock(buffer, midiBuffer);
 }
 
+void
+FilterProcessor::processLanes(float* const* channels, int numChannels, int numSamples, LaneState& state)
+{
+    // Work on local copies of the state so that the compiler can keep the lanes in registers. Lanes without a
+    // channel filter zeros.
+    float s1[numLanes];
+    float s2[numLanes];
+    float x[numLanes] = {};
+    float y[numLanes];
+    std::copy(state.s1, state.s1 + numLanes, s1);
+    std::copy(state.s2, state.s2 + numLanes, s2);
+
+    // When smoothing, the coefficients move linearly from the previous block's to this block's. Both filters
+    // are stable and the region of stable (a1, a2) is convex, so every filter along the way is stable too.
+    BiquadCoefficients c = myCoefficients;
+    const bool glide = mySmoothing && numSamples > 0 && !(myPreviousCoefficients == myCoefficients);
+    float db0 = 0.f, db1 = 0.f, db2 = 0.f, da1 = 0.f, da2 = 0.f;
+    if (glide) {
+        c = myPreviousCoefficients;
+        const float scale = 1.f / (float)numSamples;
+        db0 = (myCoefficients.b0 - c.b0) * scale;
+        db1 = (myCoefficients.b1 - c.b1) * scale;
+        db2 = (myCoefficients.b2 - c.b2) * scale;
+        da1 = (myCoefficients.a1 - c.a1) * scale;
+        da2 = (myCoefficients.a2 - c.a2) * scale;
+    }
+
+    for (int i = 0; i < numSamples; i++) {
+        if (glide) {
+            c.b0 += db0;
+            c.b1 += db1;
+            c.b2 += db2;
+            c.a1 += da1;
+            c.a2 += da2;
+        }
+
+        for (int lane = 0; lane < numChannels; lane++) {
+            x[lane] = channels[lane][i];
+        }
+
+        // Transposed direct form II, as in juce::dsp::IIR::Filter.
+        for (int lane = 0; lane < numLanes; lane++) {
+            y[lane] = c.b0 * x[lane] + s1[lane];
+            s1[lane] = c.b1 * x[lane] - c.a1 * y[lane] + s2[lane];
+            s2[lane] = c.b2 * x[lane] - c.a2 * y[lane];
+        }
+
+        for (int lane = 0; lane < numChannels; lane++) {
+            channels[lane][i] = y[lane];
+        }
+    }
+
+    // Keep a decaying state from turning into denormals.
+    for (int lane = 0; lane < numLanes; lane++) {
+        state.s1[lane] = std::abs(s1[lane]) < 1.0e-8f ? 0.f : s1[lane];
+        state.s2[lane] = std::abs(s2[lane]) < 1.0e-8f ? 0.f : s2[lane];
+    }
+}
 
 void FilterProcessor::automateParameters() {
 
     AudioPlayHead::CurrentPositionInfo posInfo;
     getPlayHead()->getCurrentPosition(posInfo);
 
-    *myFreq = getAutomationVal("freq", posInfo.timeInSamples);
-    *myQ = getAutomationVal("q", posInfo.timeInSamples);
-    *myGain = getAutomationVal("gain", posInfo.timeInSamples);
-    
+    const float freq = getBoundAutomationVal(Freq, posInfo.timeInSamples);
+    const float q = getBoundAutomationVal(Q, posInfo.timeInSamples);
+    const float gain = getBoundAutomationVal(Gain, posInfo.timeInSamples);
+
+    *myFreq = freq;
+    *myQ = q;
+    *myGain = gain;
+
+    if (myHasCoefficients && myMode == myCoefficientsMode && freq == myCoefficientsFreq && q == myCoefficientsQ && gain == myCoefficientsGain) {
+        return;
+    }
+
+    updateCoefficients(freq, q, gain);
+    myCoefficientsMode = myMode;
+    myCoefficientsFreq = freq;
+    myCoefficientsQ = q;
+    myCoefficientsGain = gain;
+
+    if (!myHasCoefficients) {
+        // Nothing to glide from.
+        myPreviousCoefficients = myCoefficients;
+        myHasCoefficients = true;
+    }
+}
+
+void
+FilterProcessor::updateCoefficients(float freq, float q, float gain)
+{
+    const double pi = juce::MathConstants<double>::pi;
+    // The tangent below is only defined strictly between 0 Hz and the Nyquist frequency.
+    const double frequency = juce::jlimit(1., mySampleRate * 0.4999, (double)freq);
+    const double invQ = 1. / std::max(0.01, (double)q);
+
+    double b0 = 1., b1 = 0., b2 = 0., a0 = 1., a1 = 0., a2 = 0.;
+
     switch (myMode)
     {
-    case FILTER_FilterFormat::Invalid:
-        return; // todo: throw error
-        break;
     case FILTER_FilterFormat::LOW_PASS:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(mySampleRate, *myFreq, *myQ);
+    {
+        const double n = 1. / std::tan(pi * frequency / mySampleRate);
+        const double nSq = n * n;
+        b0 = 1.; b1 = 2.; b2 = 1.;
+        a0 = 1. + invQ * n + nSq; a1 = 2. * (1. - nSq); a2 = 1. - invQ * n + nSq;
         break;
+    }
     case FILTER_FilterFormat::BAND_PASS:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeBandPass(mySampleRate, *myFreq, *myQ);
+    {
+        const double n = 1. / std::tan(pi * frequency / mySampleRate);
+        const double nSq = n * n;
+        b0 = n * invQ; b1 = 0.; b2 = -n * invQ;
+        a0 = 1. + invQ * n + nSq; a1 = 2. * (1. - nSq); a2 = 1. - invQ * n + nSq;
         break;
+    }
     case FILTER_FilterFormat::HIGH_PASS:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(mySampleRate, *myFreq, *myQ);
+    {
+        const double n = std::tan(pi * frequency / mySampleRate);
+        const double nSq = n * n;
+        b0 = 1.; b1 = -2.; b2 = 1.;
+        a0 = 1. + invQ * n + nSq; a1 = 2. * (nSq - 1.); a2 = 1. - invQ * n + nSq;
         break;
+    }
     case FILTER_FilterFormat::LOW_SHELF:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(mySampleRate, *myFreq, *myQ, *myGain);
-        break;
     case FILTER_FilterFormat::HIGH_SHELF:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(mySampleRate, *myFreq, *myQ, *myGain);
+    {
+        const double A = std::sqrt(std::max(0., (double)gain));
+        const double aminus1 = A - 1.;
+        const double aplus1 = A + 1.;
+        const double omega = 2. * pi * frequency / mySampleRate;
+        const double coso = std::cos(omega);
+        const double beta = std::sin(omega) * std::sqrt(A) * invQ;
+        const double aminus1TimesCoso = aminus1 * coso;
+
+        if (myMode == FILTER_FilterFormat::LOW_SHELF) {
+            b0 = A * (aplus1 - aminus1TimesCoso + beta);
+            b1 = A * 2. * (aminus1 - aplus1 * coso);
+            b2 = A * (aplus1 - aminus1TimesCoso - beta);
+            a0 = aplus1 + aminus1TimesCoso + beta;
+            a1 = -2. * (aminus1 + aplus1 * coso);
+            a2 = aplus1 + aminus1TimesCoso - beta;
+        }
+        else {
+            b0 = A * (aplus1 + aminus1TimesCoso + beta);
+            b1 = A * -2. * (aminus1 + aplus1 * coso);
+            b2 = A * (aplus1 + aminus1TimesCoso - beta);
+            a0 = aplus1 - aminus1TimesCoso + beta;
+            a1 = 2. * (aminus1 - aplus1 * coso);
+            a2 = aplus1 - aminus1TimesCoso - beta;
+        }
         break;
+    }
     case FILTER_FilterFormat::NOTCH:
-        *myFilter.state = *juce::dsp::IIR::Coefficients<float>::makeNotch(mySampleRate, *myFreq, *myQ);
+    {
+        const double n = 1. / std::tan(pi * frequency / mySampleRate);
+        const double nSq = n * n;
+        b0 = 1. + nSq; b1 = 2. * (1. - nSq); b2 = 1. + nSq;
+        a0 = 1. + invQ * n + nSq; a1 = 2. * (1. - nSq); a2 = 1. - invQ * n + nSq;
         break;
+    }
     default:
-        return; // todo: throw error
+        // An invalid mode passes the audio through. todo: throw error
         break;
     }
 
+    myCoefficients.b0 = (float)(b0 / a0);
+    myCoefficients.b1 = (float)(b1 / a0);
+    myCoefficients.b2 = (float)(b2 / a0);
+    myCoefficients.a1 = (float)(a1 / a0);
+    myCoefficients.a2 = (float)(a2 / a0);
+}
+
+double
+FilterProcessor::getTailLengthSeconds() const
+{
+    // The ringing of a resonant filter decays with a time constant of Q / (pi * frequency). Allow it to fall by 100 dB.
+    return 11.5 * myQ->load() / (juce::MathConstants<double>::pi * std::max(1.f, myFreq->load()));
 }
 
 void
 FilterProcessor::reset()
 {
-    myFilter.reset();
+    for (auto& state : myLaneStates) {
+        state = LaneState();
+    }
+    myHasCoefficients = false;
 }
 
 std::string
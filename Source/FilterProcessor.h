@@ -26,6 +26,14 @@ public:
 
     const juce::String getName();
 
+    ProcessorBase* clone(std::string newUniqueName);
+
+    bool canSkipWhenSilent() { return true; }
+
+    void clearTail() { reset(); }
+
+    double getTailLengthSeconds() const;
+
     void setMode(std::string mode);
     std::string getMode();
 
@@ -38,8 +46,54 @@ public:
     void setGain(float gain);
     float getGain();
 
+    // Whether the coefficients glide from their values in one block to their values in the next, one sample at a
+    // time, instead of jumping at the start of the block.
+    void setSmoothing(bool smoothing) { mySmoothing = smoothing; }
+    bool getSmoothing() { return mySmoothing; }
+
 private:
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> myFilter;
+    // The order of bindParameters.
+    enum BoundParameter { Freq, Q, Gain };
+
+    // The coefficients of a biquad normalized so that a0 is 1.
+    class BiquadCoefficients {
+    public:
+        float b0 = 1.f;
+        float b1 = 0.f;
+        float b2 = 0.f;
+        float a1 = 0.f;
+        float a2 = 0.f;
+
+        bool operator==(const BiquadCoefficients& other) const {
+            return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+        }
+    };
+
+    // The number of channels filtered together. Each channel is a lane of fixed-size arrays, so the compiler
+    // can filter all of them with vector instructions.
+    static constexpr int numLanes = 4;
+
+    // The state of the transposed direct form II biquads of numLanes channels.
+    class LaneState {
+    public:
+        float s1[numLanes] = {};
+        float s2[numLanes] = {};
+    };
+
+    BiquadCoefficients myCoefficients;
+    // The coefficients at the end of the previous block, from which the smoothed coefficients start.
+    BiquadCoefficients myPreviousCoefficients;
+    bool myHasCoefficients = false;
+    bool mySmoothing = false;
+
+    // The parameters that myCoefficients were computed from.
+    FILTER_FilterFormat myCoefficientsMode = FILTER_FilterFormat::Invalid;
+    float myCoefficientsFreq = 0.f;
+    float myCoefficientsQ = 0.f;
+    float myCoefficientsGain = 0.f;
+
+    std::vector<LaneState> myLaneStates;
+
     FILTER_FilterFormat myMode;
     std::atomic<float>* myFreq;
     std::atomic<float>* myQ;
@@ -53,6 +107,11 @@ private:
 
     void automateParameters();
 
+    // Compute myCoefficients in place from the mode and parameters. They're the same as those of juce::dsp::IIR::Coefficients.
+    void updateCoefficients(float freq, float q, float gain);
+
+    void processLanes(float* const* channels, int numChannels, int numSamples, LaneState& state);
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
     {
         juce::AudioProcessorValueTreeState::ParameterLayout params;
@@ -44,6 +44,8 @@ public:
 
     const juce::String getName() const { return "OscillatorProcessor"; }
 
+    ProcessorBase* clone(std::string newUniqueName) { return new OscillatorProcessor(newUniqueName, myFreq); }
+
     float myFreq;
 
 private:
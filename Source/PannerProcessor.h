@@ -13,6 +13,8 @@ public:
 
         myPan = myParameters.getRawParameterValue("pan");
 
+        bindParameters({ "pan" });
+
     }
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) {
@@ -26,7 +28,8 @@ public:
 
         automateParameters();
 
-        juce::dsp::AudioBlock<float> block(buffer);
+        // Panning is stereo, so it applies to the first two channels.
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, (size_t)std::min(2, getTotalNumOutputChannels()));
         juce::dsp::ProcessContextReplacing<float> context(block);
         myPanner.process(context);
         ProcessorBase::processBlock(buffer, midiBuffer);
@@ -37,7 +40,7 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        *myPan = getAutomationVal("pan", posInfo.timeInSamples);
+        *myPan = getBoundAutomationVal(Pan, posInfo.timeInSamples);
         updateParameters();
     }
 
@@ -47,6 +50,14 @@ public:
 
     const juce::String getName() { return "PannerProcessor"; };
 
+    bool canSkipWhenSilent() { return true; }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new PannerProcessor(newUniqueName, getRule(), getPan());
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
     void setPan(float newPanVal) { setAutomationVal("pan", newPanVal); }
     float getPan() { return getAutomationVal("pan", 0); }
 
@@ -59,6 +70,9 @@ public:
     }
 
 private:
+    // The order of bindParameters.
+    enum BoundParameter { Pan };
+
     juce::dsp::Panner<float> myPanner;
     juce::dsp::PannerRule myRule;
     std::atomic<float>* myPan;
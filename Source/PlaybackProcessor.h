@@ -11,8 +11,8 @@ public:
         int numChans = inputData.size();
         int numSamples = inputData.at(0).size();
         myPlaybackData.setSize(numChans, numSamples);
-        for (int chan = 0; chan < 2; chan++) {
-            myPlaybackData.copyFrom(chan, 0, inputData.at(std::min(numChans, chan)).data(), numSamples);
+        for (int chan = 0; chan < numChans; chan++) {
+            myPlaybackData.copyFrom(chan, 0, inputData.at(chan).data(), numSamples);
         }
     }
 
@@ -21,6 +21,10 @@ public:
         setData(input);
     }
 
+    PlaybackProcessor(std::string newUniqueName, const juce::AudioSampleBuffer& playbackData) : ProcessorBase{ newUniqueName }, myPlaybackData{ playbackData }
+    {
+    }
+
     void
     prepareToPlay(double, int) {}
 
@@ -33,7 +37,8 @@ public:
         buffer.applyGain(0.);
 
         int numSamples = std::min(buffer.getNumSamples(), myPlaybackData.getNumSamples() - (int)posInfo.timeInSamples);
-        for (int chan = 0; chan < buffer.getNumChannels() && numSamples; chan++) {
+        const int numChannels = std::min(buffer.getNumChannels(), myPlaybackData.getNumChannels());
+        for (int chan = 0; chan < numChannels && numSamples > 0; chan++) {
             auto srcPtr = myPlaybackData.getReadPointer(chan);
             srcPtr += posInfo.timeInSamples;
             buffer.copyFrom(chan, 0, srcPtr, numSamples);
@@ -47,6 +52,18 @@ public:
 
     const juce::String getName() const { return "PlaybackProcessor"; }
 
+    bool canSkipWhenSilent() { return true; }
+
+    bool hasEventsBetween(long long int startSample, long long int endSample) {
+        return startSample < myPlaybackData.getNumSamples();
+    }
+
+    long long int getLastEventSample() {
+        return std::max(ProcessorBase::getLastEventSample(), (long long int)myPlaybackData.getNumSamples());
+    }
+
+    ProcessorBase* clone(std::string newUniqueName) { return new PlaybackProcessor(newUniqueName, myPlaybackData); }
+
     void setData(py::array_t<float, py::array::c_style | py::array::forcecast> input) {
         float* input_ptr = (float*)input.data();
 
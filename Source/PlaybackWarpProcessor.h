@@ -15,11 +15,10 @@ public:
     {
         const int numChannels = (int) inputData.size();
         const int numSamples = (int)inputData.at(0).size();
-        
-        // set to stereo
-        myPlaybackData.setSize(channels, numSamples);
-        for (int chan = 0; chan < channels; chan++) {
-            myPlaybackData.copyFrom(chan, 0, inputData.at(std::min(chan, numChannels)).data(), numSamples);
+
+        myPlaybackData.setSize(numChannels, numSamples);
+        for (int chan = 0; chan < numChannels; chan++) {
+            myPlaybackData.copyFrom(chan, 0, inputData.at(chan).data(), numSamples);
         }
 
         init(sr);
@@ -31,11 +30,27 @@ public:
         init(sr);
     }
 
+    PlaybackWarpProcessor(std::string newUniqueName, const juce::AudioSampleBuffer& playbackData, double sr) : ProcessorBase{ createParameterLayout, newUniqueName }, myPlaybackData{ playbackData }
+    {
+        init(sr);
+    }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new PlaybackWarpProcessor(newUniqueName, myPlaybackData, m_sample_rate);
+        processor->m_clipInfo = m_clipInfo;
+        processor->m_clips = m_clips;
+        processor->m_time_ratio_if_warp_off = m_time_ratio_if_warp_off;
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
 private:
     void init(double sr) {
         m_sample_rate = sr;
+        channels = std::max(1, myPlaybackData.getNumChannels());
         setAutomationVal("transpose", 0.);
         myTranspose = myParameters.getRawParameterValue("transpose");
+        bindParameters({ "transpose" });
         setupRubberband(sr);
         setClipPositionsDefault();
     }
@@ -67,7 +82,7 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        *myTranspose = getAutomationVal("transpose", posInfo.timeInSamples);
+        *myTranspose = getBoundAutomationVal(Transpose, posInfo.timeInSamples);
         double scale = std::pow(2., *myTranspose / 12.);
         m_rbstretcher->setPitchScale(scale);
     }
@@ -156,6 +171,9 @@ public:
 
         double movingPPQ = posInfo.ppqPosition;
 
+        // The stretcher has a channel for every channel of the data, and the node may have more or fewer.
+        const int numOutputChannels = std::min(channels, buffer.getNumChannels());
+
         double nextPPQ = posInfo.ppqPosition + (double(buffer.getNumSamples())/ m_sample_rate) * posInfo.bpm / 60.;
         
         int numAvailable = 0;
@@ -180,7 +198,7 @@ public:
                 m_nonInterleavedBuffer.setSize(channels, numToRetrieve);
                 numToRetrieve = m_rbstretcher->retrieve(m_nonInterleavedBuffer.getArrayOfWritePointers(), numToRetrieve);
 
-                for (int chan = 0; chan < channels; chan++) {
+                for (int chan = 0; chan < numOutputChannels; chan++) {
                     auto chanPtr = m_nonInterleavedBuffer.getReadPointer(chan);
                     buffer.copyFrom(chan, numWritten, chanPtr, numToRetrieve);
                 }
@@ -210,7 +228,7 @@ public:
 
             if (nextPPQ < m_currentClip.start_pos || movingPPQ < m_currentClip.start_pos) {
                 // write some zeros into the output
-                for (int chan = 0; chan < channels; chan++) {
+                for (int chan = 0; chan < numOutputChannels; chan++) {
                     buffer.setSample(chan, numWritten, 0.f);
                 }
                 numWritten += 1;
@@ -237,7 +255,7 @@ public:
                     continue;
                 }
                 else {
-                    for (int chan = 0; chan < channels; chan++) {
+                    for (int chan = 0; chan < numOutputChannels; chan++) {
                         buffer.setSample(chan, numWritten, 0.f);
                     }
                     numWritten += 1;
@@ -316,6 +334,30 @@ public:
 
     const juce::String getName() const { return "PlaybackWarpProcessor"; }
 
+    bool canSkipWhenSilent() { return true; }
+
+    // The processor only makes sound during its clips.
+    bool hasEventsBetween(long long int startSample, long long int endSample) {
+        for (auto& clip : m_clips) {
+            auto clipStart = (long long int)(myTempoMap->ppqToSeconds(clip.start_pos) * m_sample_rate);
+            auto clipEnd = (long long int)std::ceil(myTempoMap->ppqToSeconds(clip.end_pos) * m_sample_rate);
+            if (startSample < clipEnd && clipStart < endSample) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Clips are placed in quarter notes, so the audio can last until the end of the last clip.
+    long long int getLastEventSample() {
+        double lastClipEnd = 0.;
+        for (auto& clip : m_clips) {
+            lastClipEnd = std::max(lastClipEnd, clip.end_pos);
+        }
+        auto lastClipSample = (long long int)std::ceil(myTempoMap->ppqToSeconds(lastClipEnd) * m_sample_rate);
+        return std::max(ProcessorBase::getLastEventSample(), lastClipSample);
+    }
+
     void setData(py::array_t<float, py::array::c_style | py::array::forcecast> input) {
         float* input_ptr = (float*)input.data();
         
@@ -323,10 +365,12 @@ public:
         const int numSamples = (int) input.shape(1);
 
         myPlaybackData.setSize(numChannels, numSamples);
-        for (int chan = 0; chan < channels; chan++) {
+        for (int chan = 0; chan < numChannels; chan++) {
             myPlaybackData.copyFrom(chan, 0, input_ptr, numSamples);
             input_ptr += numSamples;
         }
+        // The stretcher is made with this many channels when the processor is reset.
+        channels = std::max(1, numChannels);
     }
 
     bool loadAbletonClipInfo(const char* filepath) {
@@ -339,7 +383,11 @@ private:
 
     std::unique_ptr<RubberBand::RubberBandStretcher> m_rbstretcher;
 
-    const int channels = 2;
+    // The number of channels of the playback data.
+    int channels = 2;
+
+    // The order of bindParameters.
+    enum BoundParameter { Transpose };
 
     juce::AudioSampleBuffer m_nonInterleavedBuffer;
     int sampleReadIndex = 0;
@@ -388,7 +436,7 @@ private:
 
         m_rbstretcher = std::make_unique<RubberBand::RubberBandStretcher>(
             sr,
-            2,
+            channels,
             options,
             1.,
             1.);
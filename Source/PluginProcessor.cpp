@@ -9,9 +9,6 @@ PluginProcessor::PluginProcessor(std::string newUniqueName, double sampleRate, i
     myPluginPath = path;
 
     loadPlugin(sampleRate, samplesPerBlock);
-
-    // in processBlock, the size will be set correctly.
-    myCopyBuffer.setSize(myCopyBufferNumChans, samplesPerBlock);
 }
 
 bool
@@ -56,7 +53,7 @@ PluginProcessor::loadPlugin(double sampleRate, int samplesPerBlock) {
         // parameters from this given plugin.
         myPlugin->prepareToPlay(sampleRate, samplesPerBlock);
         myPlugin->setNonRealtime(true);
-        myCopyBufferNumChans = std::max(myPlugin->getTotalNumInputChannels(), myPlugin->getTotalNumOutputChannels());
+        myPluginNumChannels = std::max(myPlugin->getTotalNumInputChannels(), myPlugin->getTotalNumOutputChannels());
 
         mySampleRate = sampleRate;
 
@@ -78,6 +75,31 @@ PluginProcessor::~PluginProcessor() {
     }
 }
 
+ProcessorBase*
+PluginProcessor::clone(std::string newUniqueName)
+{
+    if (!myPlugin) {
+        return nullptr;
+    }
+
+    auto processor = new PluginProcessor(newUniqueName, mySampleRate, getBlockSize(), myPluginPath);
+    if (!processor->myPlugin) {
+        delete processor;
+        return nullptr;
+    }
+
+    // The plugin's own state covers settings that aren't exposed as parameters.
+    MemoryBlock state;
+    myPlugin->getStateInformation(state);
+    processor->myPlugin->setStateInformation(state.getData(), (int)state.getSize());
+
+    processor->myMidiBuffer = myMidiBuffer;
+    processor->myMidiSequenceQN = myMidiSequenceQN;
+    processor->copyAutomationFrom(*this);
+
+    return processor;
+}
+
 void PluginProcessor::setPlayHead(AudioPlayHead* newPlayHead)
 {
     AudioProcessor::setPlayHead(newPlayHead);
@@ -89,8 +111,42 @@ void PluginProcessor::setPlayHead(AudioPlayHead* newPlayHead)
 void
 PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    if (myPlugin) {
-        myPlugin->prepareToPlay(sampleRate, samplesPerBlock);
+    if (!myPlugin) {
+        return;
+    }
+
+    // The graph's channels are known now, so this is when the plugin's buses can be matched to them.
+    myPlugin->releaseResources();
+    setMainBusesLayout();
+    myPlugin->prepareToPlay(sampleRate, samplesPerBlock);
+
+    myPluginNumChannels = std::max(myPlugin->getTotalNumInputChannels(), myPlugin->getTotalNumOutputChannels());
+    const int numGraphChannels = std::max(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    myExtraChannels.setSize(std::max(0, myPluginNumChannels - numGraphChannels), samplesPerBlock);
+    myChannelPointers.resize(myPluginNumChannels);
+}
+
+void
+PluginProcessor::setMainBusesLayout()
+{
+    const int numChannels = getTotalNumOutputChannels();
+    if (numChannels <= 0) {
+        return;
+    }
+
+    auto layout = myPlugin->getBusesLayout();
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+    if (!layout.outputBuses.isEmpty()) {
+        layout.outputBuses.getReference(0) = channelSet;
+    }
+    // An effect's main input matches its output. Further graph inputs go to further buses, such as a sidechain.
+    if (!layout.inputBuses.isEmpty() && getTotalNumInputChannels() >= numChannels) {
+        layout.inputBuses.getReference(0) = channelSet;
+    }
+
+    if (layout != myPlugin->getBusesLayout() && myPlugin->checkBusesLayoutSupported(layout)) {
+        myPlugin->setBusesLayout(layout);
     }
 }
 
@@ -116,34 +172,43 @@ PluginProcessor::processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&
     if (myPlugin) {
 
         /*
-        First copy from buffer to myCopyBuffer.
-        Why? Some plugins involve multiple buses (e.g., sidechain compression). You can check this with
+        Some plugins involve multiple buses (e.g., sidechain compression). You can check this with
         `myPlugin->getBusCount()`. However, it can be difficult to add or remove buses: `myPlugin->canRemoveBus(1);`
         That function may actually not be able to remove a secondary (optional) sidechain bus.
         myPlugin->processBlock will expect to receive a buffer whose number of channels is the max(the total of all the input bus
         channels, the total of all output bus channels). When users create a graph with DawDreamer, they may pass only 1 stereo input
         to a plugin with an optional sidechain. This will cause the arg buffer to have 2 channels. However, myPlugin->processBlock would
-        expect 4 channels (2 channels for each input bus, the second bus being the unspecified sidechain input). Therefore, the solution
-        is to have myCopyBuffer be the larger size, and to copy whatever channels exist in buffer into it. In effect, the sidechain input
-        will have zeros. Then we copy the results of myCopyBuffer back to buffer so that other processors receive the result.
+        expect 4 channels (2 channels for each input bus, the second bus being the unspecified sidechain input). Therefore, the plugin
+        processes the graph's buffer in place through an array of channel pointers, and the channels the graph doesn't have
+        point to myExtraChannels, which is cleared so that the sidechain input has zeros. The plugin writes its output into
+        the graph's buffer, which is how it gets passed to other processors.
         */
 
-        int numSamples = buffer.getNumSamples();
-
-        myCopyBuffer.setSize(std::max(buffer.getNumChannels(), myCopyBufferNumChans), numSamples, false, true, false);
+        const int numSamples = buffer.getNumSamples();
+        const int numGraphChannels = std::min(buffer.getNumChannels(), myPluginNumChannels);
+        const int numExtraChannels = myPluginNumChannels - numGraphChannels;
+        if (numExtraChannels > myExtraChannels.getNumChannels() || numSamples > myExtraChannels.getNumSamples() ||
+            (int)myChannelPointers.size() != myPluginNumChannels) {
+            // Only if the processor wasn't prepared for this graph.
+            myExtraChannels.setSize(numExtraChannels, numSamples);
+            myChannelPointers.resize(myPluginNumChannels);
+        }
 
-        for (int i = 0; i < buffer.getNumChannels(); i++)
-        {
-            myCopyBuffer.copyFrom(i, 0, buffer.getReadPointer(i), numSamples);
+        for (int i = 0; i < numGraphChannels; i++) {
+            myChannelPointers[i] = buffer.getWritePointer(i);
+        }
+        for (int i = numGraphChannels; i < myPluginNumChannels; i++) {
+            // The plugin may have written to these channels during the previous block.
+            const int extraChannel = i - numGraphChannels;
+            myExtraChannels.clear(extraChannel, 0, numSamples);
+            myChannelPointers[i] = myExtraChannels.getWritePointer(extraChannel);
         }
 
-        myPlugin->processBlock(myCopyBuffer, myRenderMidiBuffer);
+        juce::AudioSampleBuffer pluginBuffer(myChannelPointers.data(), myPluginNumChannels, numSamples);
+        myPlugin->processBlock(pluginBuffer, myRenderMidiBuffer);
 
-        // copy myCopyBuffer back to buffer because this is how it gets passed to other processors.
-        for (int i = 0; i < 2; i++)
-        {
-            buffer.copyFrom(i, 0, myCopyBuffer.getReadPointer(i), numSamples);
-        }
+        // Plugins may leave their own MIDI output in the buffer.
+        myRenderMidiBuffer.clear();
 
     }
 
@@ -153,36 +218,76 @@ PluginProcessor::processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&
 void
 PluginProcessor::automateParameters() {
 
+    if (myAutomatedPluginParameters.empty()) {
+        return;
+    }
+
     AudioPlayHead::CurrentPositionInfo posInfo;
     getPlayHead()->getCurrentPosition(posInfo);
 
-    if (myPlugin) {
+    // Plugins may do a lot of work when a parameter is set, so only send the values that changed.
+    for (auto& automated : myAutomatedPluginParameters) {
+        const float value = automated.parameter->sample(posInfo.timeInSamples);
+        if (value != automated.lastValue) {
+            myPlugin->setParameter(automated.index, value);
+            automated.lastValue = value;
+        }
+    }
+}
 
-        for (int i = 0; i < myPlugin->AudioProcessor::getNumParameters(); i++) {
+void
+PluginProcessor::pushParameters() {
 
-            auto paramID = std::to_string(i);
+    myAutomatedPluginParameters.clear();
 
-            auto theParameter = ((AutomateParameterFloat*)myParameters.getParameter(paramID));
-            if (theParameter) {
-                myPlugin->setParameter(i, theParameter->sample(posInfo.timeInSamples));
-            }
-            else {
-                std::cout << "Error automateParameters: " << myPlugin->getParameterName(i) << std::endl;
-            }
+    if (!myPlugin) {
+        return;
+    }
+
+    for (int i = 0; i < myPlugin->AudioProcessor::getNumParameters(); i++) {
+
+        auto paramID = std::to_string(i);
+
+        auto theParameter = ((AutomateParameterFloat*)myParameters.getParameter(paramID));
+        if (!theParameter) {
+            std::cout << "Error automateParameters: " << myPlugin->getParameterName(i) << std::endl;
+            continue;
+        }
+
+        const float value = theParameter->sample(0);
+        myPlugin->setParameter(i, value);
+
+        if (theParameter->isAutomated()) {
+            myAutomatedPluginParameters.push_back({ i, theParameter, value });
         }
     }
 }
 
+double
+PluginProcessor::getTailLengthSeconds() const
+{
+    return myPlugin ? myPlugin->getTailLengthSeconds() : 0.;
+}
+
+long long int
+PluginProcessor::getLastEventSample()
+{
+    return std::max(ProcessorBase::getLastEventSample(), (long long int)myMergedMidiBuffer.getLastEventTime());
+}
+
 void
 PluginProcessor::reset()
 {
     myPlugin->reset();
 
+    pushParameters();
+
     if (myMidiIterator) {
         delete myMidiIterator;
     }
 
-    myMidiIterator = new MidiBuffer::Iterator(myMidiBuffer); // todo: deprecated.
+    mergeMidi(myMidiBuffer, myMidiSequenceQN, myMergedMidiBuffer);
+    myMidiIterator = new MidiBuffer::Iterator(myMergedMidiBuffer); // todo: deprecated.
     myMidiEventsDoRemain = myMidiIterator->getNextEvent(myMidiMessage, myMidiMessagePosition);
     myRenderMidiBuffer.clear();
 }
@@ -399,41 +504,28 @@ PluginProcessor::getPluginParameterSize()
 
 int
 PluginProcessor::getNumMidiEvents() {
-    return myMidiBuffer.getNumEvents();
+    return myMidiBuffer.getNumEvents() + myMidiSequenceQN.getNumEvents();
 };
 
 bool
-PluginProcessor::loadMidi(const std::string& path)
+PluginProcessor::loadMidi(const std::string& path, bool beats)
 {
-    File file = File(path);
-    FileInputStream fileStream(file);
-    MidiFile midiFile;
-    midiFile.readFrom(fileStream);
-    midiFile.convertTimestampTicksToSeconds();
-    myMidiBuffer.clear();
-
-    for (int t = 0; t < midiFile.getNumTracks(); t++) {
-        const MidiMessageSequence* track = midiFile.getTrack(t);
-        for (int i = 0; i < track->getNumEvents(); i++) {
-            MidiMessage& m = track->getEventPointer(i)->message;
-            int sampleOffset = (int)(mySampleRate * m.getTimeStamp());
-            myMidiBuffer.addEvent(m, sampleOffset);
-        }
-    }
-
-    return true;
+    clearMidi();
+    return readMidiFile(path, beats, mySampleRate, myMidiBuffer, myMidiSequenceQN);
 }
 
 void
 PluginProcessor::clearMidi() {
     myMidiBuffer.clear();
+    myMidiSequenceQN.clear();
 }
 
 bool
 PluginProcessor::addMidiNote(uint8  midiNote,
     uint8  midiVelocity,
     const double noteStart,
-    const double noteLength) {
+    const double noteLength,
+    bool beats) {
 
     if (midiNote > 255) midiNote = 255;
     if (midiNote < 0) midiNote = 0;
@@ -452,6 +544,14 @@ PluginProcessor::addMidiNote(uint8  midiNote,
         midiNote,
         midiVelocity);
 
+    if (beats) {
+        onMessage.setTimeStamp(noteStart);
+        offMessage.setTimeStamp(noteStart + noteLength);
+        myMidiSequenceQN.addEvent(onMessage);
+        myMidiSequenceQN.addEvent(offMessage);
+        return true;
+    }
+
     auto startTime = noteStart * mySampleRate;
     onMessage.setTimeStamp(startTime);
     offMessage.setTimeStamp(startTime + noteLength * mySampleRate);
@@ -517,8 +617,8 @@ PluginProcessorWrapper::wrapperSetParameter(int parameter, float value)
 }
 
 bool
-PluginProcessorWrapper::wrapperSetAutomation(int parameterIndex, py::array input) {
-    return PluginProcessorWrapper::setAutomation(std::to_string(parameterIndex), input);
+PluginProcessorWrapper::wrapperSetAutomation(int parameterIndex, py::array input, std::string mode, double rate, bool ppq) {
+    return PluginProcessorWrapper::setAutomation(std::to_string(parameterIndex), input, mode, rate, ppq);
 }
 
 int
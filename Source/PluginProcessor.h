@@ -36,7 +36,13 @@ public:
 
     const juce::String getName() const { return "PluginProcessor"; }
 
-    bool loadMidi(const std::string& path);
+    ProcessorBase* clone(std::string newUniqueName);
+
+    double getTailLengthSeconds() const;
+
+    long long int getLastEventSample();
+
+    bool loadMidi(const std::string& path, bool beats);
 
     void clearMidi();
 
@@ -45,7 +51,8 @@ public:
     bool addMidiNote(const uint8  midiNote,
         const uint8  midiVelocity,
         const double noteStart,
-        const double noteLength);
+        const double noteLength,
+        bool beats);
 
     void setPlayHead(AudioPlayHead* newPlayHead);
 
@@ -57,6 +64,9 @@ private:
     double mySampleRate;
 
     MidiBuffer myMidiBuffer;
+    // MIDI timed in quarter notes, and all of the MIDI timed in samples for the current render.
+    MidiMessageSequence myMidiSequenceQN;
+    MidiBuffer myMergedMidiBuffer;
     MidiBuffer myRenderMidiBuffer;
     MidiMessage myMidiMessage;
     int myMidiMessagePosition = -1;
@@ -66,12 +76,31 @@ private:
 
     void automateParameters();
 
+    // Ask the plugin for main buses with the graph's number of channels, if it supports them.
+    void setMainBusesLayout();
+
+    // Push every parameter's value to the plugin at the start of a render, and note which ones are automated.
+    void pushParameters();
+
+    // The plugin parameters whose automation changes during the current render, with the value last sent to the plugin.
+    class AutomatedPluginParameter {
+    public:
+        int index;
+        AutomateParameterFloat* parameter;
+        float lastValue;
+    };
+    std::vector<AutomatedPluginParameter> myAutomatedPluginParameters;
+
 protected:
 
     std::unique_ptr<juce::AudioPluginInstance, std::default_delete<juce::AudioPluginInstance>> myPlugin;
-    // For an explanation of myCopyBuffer, read PluginProcessor::processBlock
-    juce::AudioSampleBuffer myCopyBuffer;
-    int myCopyBufferNumChans = 2;
+
+    // The plugin processes max(total input channels, total output channels) of all its buses. The graph's buffer
+    // backs as many of them as it has, and silent channels of myExtraChannels back the rest, such as an unconnected
+    // sidechain. For an explanation, read PluginProcessor::processBlock.
+    int myPluginNumChannels = 2;
+    juce::AudioSampleBuffer myExtraChannels;
+    std::vector<float*> myChannelPointers;
 
 };
 
@@ -93,7 +122,7 @@ public:
 
     bool wrapperSetParameter(int parameter, float value);
 
-    bool wrapperSetAutomation(int parameterIndex, py::array input);
+    bool wrapperSetAutomation(int parameterIndex, py::array input, std::string mode, double rate, bool ppq);
 
     int wrapperGetPluginParameterSize();
 
@@ -1,5 +1,7 @@
 #include "ProcessorBase.h"
 
+std::atomic<int> ProcessorBase::myNumInstances{ 0 };
+
 void
 ProcessorBase::getStateInformation(juce::MemoryBlock& destData)
 {
@@ -18,14 +20,296 @@ ProcessorBase::setStateInformation(const void* data, int sizeInBytes)
             myParameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 }
 
-bool ProcessorBase::setAutomation(std::string parameterName, py::array input) {
+bool ProcessorBase::startFileRecording(juce::TimeSliceThread& writerThread, double sampleRate, long long int numSamples) {
+
+    stopFileRecording();
+
+    if (myRecordFilePath.empty()) {
+        return true;
+    }
+
+    File file(myRecordFilePath);
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto format = formatManager.findFormatForFileExtension(file.getFileExtension());
+    if (!format) {
+        std::cerr << "Unable to record to " << myRecordFilePath << ". Use a .wav, .flac or .aiff extension." << std::endl;
+        return false;
+    }
+
+    file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(file.createOutputStream());
+    if (!stream) {
+        std::cerr << "Unable to open " << myRecordFilePath << " for writing." << std::endl;
+        return false;
+    }
+
+    const int numChannels = std::max(1, getTotalNumOutputChannels());
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+        myRecordFileBitDepth, {}, 0));
+    if (!writer) {
+        std::cerr << "Unable to record to " << myRecordFilePath << " with a bit depth of " << myRecordFileBitDepth << "." << std::endl;
+        return false;
+    }
+    stream.release(); // the writer owns the stream now.
+
+    // The render thread pushes blocks into the writer's FIFO and writerThread drains it to disk.
+    const int numSamplesToBuffer = std::max(1 << 16, getBlockSize() * 8);
+    myFileWriter = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(writer.release(), writerThread, numSamplesToBuffer);
+    myRecordFileNumSamples = numSamples;
+
+    return true;
+}
+
+void ProcessorBase::stopFileRecording() {
+    // Deleting the ThreadedWriter flushes its FIFO and finalizes the file.
+    myFileWriter = nullptr;
+}
+
+void ProcessorBase::writeToFile(juce::AudioSampleBuffer& buffer, long long int timeInSamples) {
+
+    const int numSamples = (int)std::min((long long int)buffer.getNumSamples(), myRecordFileNumSamples - timeInSamples);
+    if (numSamples <= 0) {
+        return;
+    }
+
+    // Rendering isn't real-time, so wait for the writer thread instead of dropping audio when the FIFO is full.
+    while (!myFileWriter->write(buffer.getArrayOfReadPointers(), numSamples)) {
+        juce::Thread::sleep(1);
+    }
+}
+
+// Convert to IEEE half precision, rounding to the nearest value.
+static uint16_t floatToHalf(float value) {
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    bits &= 0x7fffffff;
+
+    if (bits >= 0x7f800000) {
+        // Infinity or NaN.
+        return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0);
+    }
+    if (bits >= 0x477ff000) {
+        // Too large, so round to infinity.
+        return sign | 0x7c00;
+    }
+    if (bits < 0x38800000) {
+        // Subnormal in half precision, where a unit is 2^-24.
+        return sign | (uint16_t)std::nearbyint(std::abs(value) * 16777216.f);
+    }
+
+    // Rebias the exponent and round the mantissa to even.
+    uint32_t half = (bits - 0x38000000) >> 13;
+    const uint32_t remainder = bits & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return sign | (uint16_t)half;
+}
+
+bool ProcessorBase::setRecordingOptions(std::vector<int> channels, std::string format, int decimation, double startSeconds, double endSeconds) {
+
+    RecordFormat recordFormat;
+    if (format == "float32") {
+        recordFormat = RecordFormat::Float32;
+    }
+    else if (format == "int16") {
+        recordFormat = RecordFormat::Int16;
+    }
+    else if (format == "float16") {
+        recordFormat = RecordFormat::Float16;
+    }
+    else {
+        std::cerr << "Unknown recording format " << format << ". Use \"float32\", \"int16\" or \"float16\"." << std::endl;
+        return false;
+    }
+
+    for (int chan : channels) {
+        if (chan < 0) {
+            std::cerr << "Error: recorded channels can't be negative." << std::endl;
+            return false;
+        }
+    }
+    if (decimation < 1) {
+        std::cerr << "Error: the recording decimation must be at least 1." << std::endl;
+        return false;
+    }
+    if (startSeconds < 0. || (endSeconds > 0. && endSeconds <= startSeconds)) {
+        std::cerr << "Error: the recording window must start at 0 or later and end after it starts." << std::endl;
+        return false;
+    }
+
+    myRecordChannels = channels;
+    myRecordDecimation = decimation;
+    myRecordStartSeconds = startSeconds;
+    myRecordEndSeconds = endSeconds;
+
+    if (recordFormat != myRecordFormat) {
+        // Release the storage of the previous format.
+        myRecordBuffer = std::make_shared<juce::AudioSampleBuffer>();
+        myRecordBuffer16 = std::make_shared<std::vector<uint16_t>>();
+        myRecordCapacity = 0;
+        myRecordNumFrames = 0;
+        myRecordFormat = recordFormat;
+    }
+
+    return true;
+}
+
+int ProcessorBase::getNumRecordedFrames(long long int numSamples) {
+    const long long int end = std::min(numSamples, myRecordEndSample);
+    if (end <= myRecordStartSample) {
+        return 0;
+    }
+    return (int)((end - myRecordStartSample + myRecordDecimation - 1) / myRecordDecimation);
+}
+
+void ProcessorBase::setRecorderLength(int numSamples) {
+
+    const double sampleRate = getSampleRate();
+    myRecordStartSample = (long long int)std::llround(myRecordStartSeconds * sampleRate);
+    myRecordEndSample = myRecordEndSeconds > 0. ? std::min((long long int)numSamples, (long long int)std::llround(myRecordEndSeconds * sampleRate)) : numSamples;
+
+    myRecordedChannels = myRecordChannels;
+    if (myRecordedChannels.empty()) {
+        for (int chan = 0; chan < getTotalNumOutputChannels(); chan++) {
+            myRecordedChannels.push_back(chan);
+        }
+    }
+
+    const int numChannels = (int)myRecordedChannels.size();
+    const int numFrames = m_recordEnable ? getNumRecordedFrames(numSamples) : 0;
+
+    if (myRecordFormat == RecordFormat::Float32) {
+        if (myRecordBuffer.use_count() > 1) {
+            // A numpy array from getAudioFrames still refers to the previous recording.
+            myRecordBuffer = std::make_shared<juce::AudioSampleBuffer>();
+        }
+        myRecordBuffer->setSize(numChannels, numFrames);
+    }
+    else {
+        if (myRecordBuffer16.use_count() > 1) {
+            myRecordBuffer16 = std::make_shared<std::vector<uint16_t>>();
+        }
+        myRecordBuffer16->resize((size_t)numChannels * (size_t)numFrames);
+        myRecordCapacity = numFrames;
+        myRecordNumFrames = numFrames;
+    }
+}
+
+void ProcessorBase::trimRecording(int numSamples) {
+
+    const int numFrames = getNumRecordedFrames(numSamples);
+
+    if (myRecordFormat == RecordFormat::Float32) {
+        if (numFrames < myRecordBuffer->getNumSamples()) {
+            myRecordBuffer->setSize(myRecordBuffer->getNumChannels(), numFrames, true, false, true);
+        }
+    }
+    else {
+        myRecordNumFrames = std::min(myRecordNumFrames, numFrames);
+    }
+}
+
+void ProcessorBase::recordBlock(juce::AudioSampleBuffer& buffer, long long int timeInSamples) {
+
+    // Find the first sample of the block that's on the decimation grid of the window.
+    const long long int blockEnd = std::min(timeInSamples + buffer.getNumSamples(), myRecordEndSample);
+    long long int first = std::max(timeInSamples, myRecordStartSample);
+    first += (myRecordDecimation - (first - myRecordStartSample) % myRecordDecimation) % myRecordDecimation;
+    if (first >= blockEnd) {
+        return;
+    }
+
+    const int firstFrame = (int)((first - myRecordStartSample) / myRecordDecimation);
+    const int numFrames = (int)((blockEnd - first + myRecordDecimation - 1) / myRecordDecimation);
+    const int offset = (int)(first - timeInSamples);
+    const int step = myRecordDecimation;
+
+    for (int i = 0; i < (int)myRecordedChannels.size(); i++) {
+        const int chan = myRecordedChannels[i];
+
+        if (myRecordFormat == RecordFormat::Float32) {
+            if (chan >= buffer.getNumChannels()) {
+                myRecordBuffer->clear(i, firstFrame, numFrames);
+            }
+            else if (step == 1) {
+                myRecordBuffer->copyFrom(i, firstFrame, buffer, chan, offset, numFrames);
+            }
+            else {
+                const float* input = buffer.getReadPointer(chan, offset);
+                float* output = myRecordBuffer->getWritePointer(i, firstFrame);
+                for (int frame = 0; frame < numFrames; frame++) {
+                    output[frame] = input[frame * step];
+                }
+            }
+            continue;
+        }
+
+        uint16_t* output = myRecordBuffer16->data() + (size_t)i * (size_t)myRecordCapacity + firstFrame;
+        if (chan >= buffer.getNumChannels()) {
+            std::fill(output, output + numFrames, (uint16_t)0);
+            continue;
+        }
+
+        const float* input = buffer.getReadPointer(chan, offset);
+        if (myRecordFormat == RecordFormat::Int16) {
+            for (int frame = 0; frame < numFrames; frame++) {
+                output[frame] = (uint16_t)(int16_t)juce::jlimit(-32768, 32767, juce::roundToInt(input[frame * step] * 32767.f));
+            }
+        }
+        else {
+            for (int frame = 0; frame < numFrames; frame++) {
+                output[frame] = floatToHalf(input[frame * step]);
+            }
+        }
+    }
+}
+
+py::array
+ProcessorBase::getAudioFrames16()
+{
+    const py::dtype dtype = myRecordFormat == RecordFormat::Int16 ? py::dtype::of<int16_t>() : py::dtype("e");
+    const py::ssize_t numChannels = (py::ssize_t)myRecordedChannels.size();
+
+    if (myRecordNumFrames == 0) {
+        return py::array(dtype, { numChannels, (py::ssize_t)0 });
+    }
+
+    // Like the float recording, give numpy a read-only view that keeps the recording alive.
+    auto owner = new std::shared_ptr<std::vector<uint16_t>>(myRecordBuffer16);
+    py::capsule base(owner, [](void* p) { delete reinterpret_cast<std::shared_ptr<std::vector<uint16_t>>*>(p); });
+
+    py::array arr(dtype, { numChannels, (py::ssize_t)myRecordNumFrames },
+        { (py::ssize_t)(myRecordCapacity * sizeof(uint16_t)), (py::ssize_t)sizeof(uint16_t) }, myRecordBuffer16->data(), base);
+    arr.attr("setflags")(py::arg("write") = false);
+
+    return arr;
+}
+
+bool ProcessorBase::setAutomation(std::string parameterName, py::array input, std::string mode, double rate, bool ppq) {
 
     try
     {
         auto parameter = (AutomateParameterFloat*)myParameters.getParameter(parameterName);  // todo: why do we have to cast to AutomateParameterFloat instead of AutomateParameter
 
         if (parameter) {
-            return parameter->setAutomation(input);
+            if (mode == "samples") {
+                return parameter->setAutomation(input);
+            }
+            else if (mode == "control") {
+                return parameter->setControlAutomation(input, rate, ppq);
+            }
+            else if (mode == "breakpoints") {
+                return parameter->setBreakpointAutomation(input, ppq);
+            }
+            std::cerr << "Failed to set '" << parameterName << "' automation: unknown mode " << mode
+                << ". Use \"samples\", \"control\" or \"breakpoints\"." << std::endl;
+            return false;
         }
         else {
             std::cerr << "Failed to find parameter: " << parameterName << std::endl;
@@ -63,6 +347,37 @@ bool ProcessorBase::setAutomationVal(std::string parameterName, float val) {
     return true;
 }
 
+bool ProcessorBase::setAutomationValues(std::string parameterName, const std::vector<float>& values) {
+
+    if (values.empty()) {
+        std::cerr << "Failed to set '" << parameterName << "' automation: no values were given." << std::endl;
+        return false;
+    }
+
+    auto parameter = (AutomateParameterFloat*)myParameters.getParameter(parameterName);  // todo: why do we have to cast to AutomateParameterFloat instead of AutomateParameter
+    if (parameter) {
+        parameter->setAutomation(values);
+        return true;
+    }
+
+    std::cerr << "Failed to find parameter: " << parameterName << std::endl;
+    return false;
+}
+
+void ProcessorBase::copyAutomationFrom(ProcessorBase& other) {
+
+    for (auto otherParameter : other.getParameters()) {
+        auto source = dynamic_cast<AutomateParameterFloat*>(otherParameter);
+        if (!source) {
+            continue;
+        }
+        auto destination = dynamic_cast<AutomateParameterFloat*>(myParameters.getParameter(source->paramID));
+        if (destination) {
+            destination->copyAutomation(*source);
+        }
+    }
+}
+
 std::vector<float> ProcessorBase::getAutomation(std::string parameterName) {
     auto parameter = (AutomateParameterFloat*)myParameters.getParameter(parameterName);  // todo: why do we have to cast to AutomateParameterFloat instead of AutomateParameter
 
@@ -76,6 +391,20 @@ std::vector<float> ProcessorBase::getAutomation(std::string parameterName) {
     }
 }
 
+void ProcessorBase::bindParameters(const std::vector<std::string>& parameterNames) {
+
+    myBoundParameters.clear();
+
+    for (auto& parameterName : parameterNames) {
+        auto parameter = dynamic_cast<AutomateParameterFloat*>(myParameters.getParameter(parameterName));
+        if (!parameter) {
+            // The processor's parameter layout and its bindings disagree, which is a programming error.
+            throw std::runtime_error("Failed to bind parameter: " + parameterName);
+        }
+        myBoundParameters.push_back(parameter);
+    }
+}
+
 float ProcessorBase::getAutomationVal(std::string parameterName, int index) {
     auto parameter = (AutomateParameterFloat*)myParameters.getParameter(parameterName);  // todo: why do we have to cast to AutomateParameterFloat instead of AutomateParameter
 
@@ -101,4 +430,76 @@ py::array_t<float> ProcessorBase::getAutomationNumpy(std::string parameterName)
     }
 
     return arr;
-}
\ No newline at end of file
+}
+long long int ProcessorBase::getLastEventSample() {
+
+    size_t lastChange = 0;
+    for (auto processorParameter : getParameters()) {
+        auto parameter = dynamic_cast<AutomateParameterFloat*>(processorParameter);
+        if (parameter) {
+            lastChange = std::max(lastChange, parameter->getLastChange());
+        }
+    }
+    return (long long int)lastChange;
+}
+
+void ProcessorBase::setTempoMap(std::shared_ptr<const TempoMap> tempoMap) {
+    myTempoMap = tempoMap;
+
+    for (auto processorParameter : getParameters()) {
+        auto parameter = dynamic_cast<AutomateParameterFloat*>(processorParameter);
+        if (parameter) {
+            parameter->setTiming(getSampleRate(), tempoMap);
+        }
+    }
+}
+
+bool ProcessorBase::readMidiFile(const std::string& path, bool beats, double sampleRate, juce::MidiBuffer& midiBuffer, juce::MidiMessageSequence& midiSequenceQN) {
+
+    File file = File(path);
+    FileInputStream fileStream(file);
+    MidiFile midiFile;
+    if (!fileStream.openedOk() || !midiFile.readFrom(fileStream)) {
+        std::cerr << "Unable to read MIDI file: " << path << std::endl;
+        return false;
+    }
+
+    const short ticksPerQuarterNote = midiFile.getTimeFormat();
+    if (beats && ticksPerQuarterNote <= 0) {
+        std::cerr << "Unable to read " << path << " in beats because its times are in SMPTE format." << std::endl;
+        return false;
+    }
+
+    if (!beats) {
+        midiFile.convertTimestampTicksToSeconds();
+    }
+
+    for (int t = 0; t < midiFile.getNumTracks(); t++) {
+        const MidiMessageSequence* track = midiFile.getTrack(t);
+        for (int i = 0; i < track->getNumEvents(); i++) {
+            MidiMessage m = track->getEventPointer(i)->message;
+            if (beats) {
+                m.setTimeStamp(m.getTimeStamp() / ticksPerQuarterNote);
+                midiSequenceQN.addEvent(m);
+            }
+            else {
+                int sampleOffset = (int)(sampleRate * m.getTimeStamp());
+                midiBuffer.addEvent(m, sampleOffset);
+            }
+        }
+    }
+
+    midiSequenceQN.sort();
+
+    return true;
+}
+
+void ProcessorBase::mergeMidi(const juce::MidiBuffer& midiBuffer, const juce::MidiMessageSequence& midiSequenceQN, juce::MidiBuffer& mergedMidiBuffer) {
+
+    mergedMidiBuffer = midiBuffer;
+
+    for (auto event : midiSequenceQN) {
+        const double seconds = myTempoMap->ppqToSeconds(event->message.getTimeStamp());
+        mergedMidiBuffer.addEvent(event->message, (int)std::round(seconds * getSampleRate()));
+    }
+}
@@ -4,6 +4,9 @@
 #include "custom_pybind_wrappers.h"
 #include "CustomParameters.h"
 
+// The sample format of a processor's recording in memory.
+enum class RecordFormat { Float32, Int16, Float16 };
+
 
 class ProcessorBase : public juce::AudioProcessor
 {
@@ -12,12 +15,19 @@ public:
     ProcessorBase(std::function< juce::AudioProcessorValueTreeState::ParameterLayout()> createParameterFunc, std::string newUniqueName = "") : 
         myUniqueName{ newUniqueName }, myParameters(*this, nullptr, "PARAMETERS", createParameterFunc()) {
         this->setNonRealtime(true);
+        myNumInstances++;
     }
 
     ProcessorBase(std::string newUniqueName = "") : myUniqueName{ newUniqueName }, myParameters(*this, nullptr, newUniqueName.c_str(), createEmptyParameterLayout()) {
         this->setNonRealtime(true);
+        myNumInstances++;
     }
 
+    ~ProcessorBase() { myNumInstances--; }
+
+    // The number of processors alive in this process, including those that only a RenderEngine refers to.
+    static int getNumInstances() { return myNumInstances.load(); }
+
     //==============================================================================
     void prepareToPlay(double, int) override {}
     void releaseResources() override {}
@@ -25,21 +35,22 @@ public:
     // All subclasses of ProcessorBase should implement processBlock and call ProcessorBase::processBlock at the end
     // of their implementation. The ProcessorBase implementation takes care of recording.
     void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) {
-    
-        if (!m_recordEnable) {
+
+        if (!m_recordEnable && !myFileWriter) {
             return;
         }
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        const int numberChannels = buffer.getNumChannels();
+        if (myFileWriter) {
+            writeToFile(buffer, posInfo.timeInSamples);
+        }
 
-        for (int chan = 0; chan < numberChannels; chan++) {
-            // Write the sample to the engine's history for the correct channel.       
-            int numSamplesToCopy = std::min(buffer.getNumSamples(), (int) myRecordBuffer.getNumSamples() -(int)posInfo.timeInSamples);
-            // assume numSamplesToCopy > 0
-            myRecordBuffer.copyFrom(chan, posInfo.timeInSamples, buffer.getReadPointer(chan), numSamplesToCopy);
+        if (!m_recordEnable) {
+            return;
         }
+
+        recordBlock(buffer, posInfo.timeInSamples);
     }
 
     //==============================================================================
@@ -63,10 +74,16 @@ public:
     void getStateInformation(juce::MemoryBlock&);
     void setStateInformation(const void*, int);
 
-    bool setAutomation(std::string parameterName, py::array input);
+    // mode is "samples" for one value per sample, "control" for values at rate per second (or per quarter note
+    // if ppq) that are interpolated linearly, or "breakpoints" for rows of (time, value[, curve]).
+    bool setAutomation(std::string parameterName, py::array input, std::string mode = "samples", double rate = 0., bool ppq = false);
 
     bool setAutomationVal(std::string parameterName, float val);
 
+    bool setAutomationValues(std::string parameterName, const std::vector<float>& values);
+
+    bool hasParameter(std::string parameterName) { return myParameters.getParameter(parameterName) != nullptr; }
+
     float getAutomationVal(std::string parameterName, int index);
 
     std::vector<float> getAutomation(std::string parameterName);
@@ -75,46 +92,136 @@ public:
     //==============================================================================
     std::string getUniqueName() { return myUniqueName; }
 
+    // Make an independent processor with the same settings, data and automation as this one,
+    // so that it can render on another thread. Returns nullptr if the processor can't be cloned.
+    // The caller owns the clone.
+    virtual ProcessorBase* clone(std::string newUniqueName) { return nullptr; }
+
+    // Copy the automation of every parameter that this processor shares with other.
+    void copyAutomationFrom(ProcessorBase& other);
+
     void automateParameters() {};
 
     void setRecordEnable(bool recordEnable) { m_recordEnable = recordEnable; }
     bool getRecordEnable() { return m_recordEnable; }
 
-    py::array_t<float>
+    // Record only the given output channels (all of them if empty), as "float32", "int16" or "float16",
+    // keeping every decimation-th sample in the window [startSeconds, endSeconds). An endSeconds of 0 or less
+    // records until the end of the render.
+    bool setRecordingOptions(std::vector<int> channels, std::string format, int decimation, double startSeconds, double endSeconds);
+
+    py::array
     getAudioFrames()
     {
-        size_t num_channels = myRecordBuffer.getNumChannels();
-        size_t num_samples = myRecordBuffer.getNumSamples();
-
-        py::array_t<float, py::array::c_style> arr({ (int)num_channels, (int)num_samples });
+        if (myRecordFormat != RecordFormat::Float32) {
+            return getAudioFrames16();
+        }
 
-        auto ra = arr.mutable_unchecked();
+        size_t num_channels = myRecordBuffer->getNumChannels();
+        size_t num_samples = myRecordBuffer->getNumSamples();
 
-        for (size_t i = 0; i < num_channels; i++)
-        {
-            for (size_t j = 0; j < num_samples; j++)
-            {
-                ra(i, j) = myRecordBuffer.getSample(i, j);
-            }
+        if (num_channels == 0 || num_samples == 0) {
+            py::array_t<float, py::array::c_style> arr({ (int)num_channels, (int)num_samples });
+            return arr;
         }
 
+        // Rather than copying, give numpy a read-only view of the recording. The array keeps the
+        // recording alive through its base capsule, and setRecorderLength allocates a new buffer
+        // instead of overwriting one that Python still references.
+        auto owner = new std::shared_ptr<juce::AudioSampleBuffer>(myRecordBuffer);
+        py::capsule base(owner, [](void* p) { delete reinterpret_cast<std::shared_ptr<juce::AudioSampleBuffer>*>(p); });
+
+        // AudioSampleBuffer stores its channels in one allocation with a constant distance between them.
+        py::ssize_t channelStride = num_channels > 1 ?
+            (py::ssize_t)((const char*)myRecordBuffer->getReadPointer(1) - (const char*)myRecordBuffer->getReadPointer(0)) :
+            (py::ssize_t)(num_samples * sizeof(float));
+
+        py::array_t<float> arr({ (py::ssize_t)num_channels, (py::ssize_t)num_samples }, { channelStride, (py::ssize_t)sizeof(float) },
+            myRecordBuffer->getReadPointer(0), base);
+        arr.attr("setflags")(py::arg("write") = false);
+
         return arr;
     }
 
-    void setRecorderLength(int numSamples) {
-        if (m_recordEnable) {
-            myRecordBuffer.setSize(2, numSamples);
-        }
-        else {
-            myRecordBuffer.setSize(2, 0);
-        }
+    const juce::AudioSampleBuffer& getRecordBuffer() { return *myRecordBuffer; }
+
+    // Stream this processor's output to an audio file during renders. The format (WAV, FLAC or AIFF)
+    // is chosen by the file extension. An empty path disables it.
+    void setRecordToFile(std::string filePath, int bitDepth) {
+        myRecordFilePath = filePath;
+        myRecordFileBitDepth = bitDepth;
     }
+    std::string getRecordFilePath() { return myRecordFilePath; }
+
+    // Called by the RenderEngine at the start and end of a render.
+    bool startFileRecording(juce::TimeSliceThread& writerThread, double sampleRate, long long int numSamples);
+    void stopFileRecording();
+
+    // The sample after which the processor receives no more MIDI events or automation changes, and after which
+    // its output can only die away. Subclasses with MIDI or other timed data extend this.
+    virtual long long int getLastEventSample();
+
+    // Whether the output is silent whenever the input has been silent for longer than getTailLengthSeconds() and
+    // hasEventsBetween is false, so that the engine can skip processBlock. Processors that can make sound on
+    // their own, such as oscillators, instruments and arbitrary plugins, keep the default of false.
+    virtual bool canSkipWhenSilent() { return false; }
+
+    // Clear what's left of the tail, such as filter and delay state, without moving the processor's position.
+    // The engine calls it before processing a processor that it skipped, so that the decayed tail doesn't resume.
+    virtual void clearTail() {}
+
+    // Whether MIDI or other timed data, such as playback audio, makes sound in [startSample, endSample).
+    virtual bool hasEventsBetween(long long int startSample, long long int endSample) { return false; }
+
+    // The tempo map of the engine, which converts times in quarter notes to samples. It's set before every render.
+    void setTempoMap(std::shared_ptr<const TempoMap> tempoMap);
+
+    // The number of channels of each input, in the order of the graph. The RenderEngine sets it in loadGraph.
+    void setInputChannelCounts(const std::vector<int>& inputChannelCounts) { myInputChannelCounts = inputChannelCounts; }
+
+    // Shorten the recording after a render that ended after numSamples samples.
+    void trimRecording(int numSamples);
+
+    // Allocate the recording for a render of numSamples samples, or an empty one if recording is disabled.
+    void setRecorderLength(int numSamples);
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessorBase)
     std::string myUniqueName;
-    juce::AudioSampleBuffer myRecordBuffer;
+    static std::atomic<int> myNumInstances;
+    std::shared_ptr<juce::AudioSampleBuffer> myRecordBuffer = std::make_shared<juce::AudioSampleBuffer>();
+
+    std::string myRecordFilePath;
+    int myRecordFileBitDepth = 24;
+    long long int myRecordFileNumSamples = 0;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> myFileWriter;
+
+    void writeToFile(juce::AudioSampleBuffer& buffer, long long int timeInSamples);
+
+    std::vector<int> myRecordChannels;
+    // The channels recorded during the current render.
+    std::vector<int> myRecordedChannels;
+    RecordFormat myRecordFormat = RecordFormat::Float32;
+    int myRecordDecimation = 1;
+    double myRecordStartSeconds = 0.;
+    double myRecordEndSeconds = 0.;
+
+    // The window of the current render that's recorded, in samples.
+    long long int myRecordStartSample = 0;
+    long long int myRecordEndSample = 0;
+
+    // Int16 and float16 recordings, channel after channel, each with room for myRecordCapacity frames.
+    std::shared_ptr<std::vector<uint16_t>> myRecordBuffer16 = std::make_shared<std::vector<uint16_t>>();
+    int myRecordCapacity = 0;
+    int myRecordNumFrames = 0;
+
+    // The number of recorded frames that come from the first numSamples samples of the render.
+    int getNumRecordedFrames(long long int numSamples);
+
+    void recordBlock(juce::AudioSampleBuffer& buffer, long long int timeInSamples);
+
+    py::array getAudioFrames16();
  
 protected:
 
@@ -126,4 +233,22 @@ protected:
         return params;
     }
     bool m_recordEnable = false;
+
+    // Look up parameters by name once, so that automateParameters can read the i-th of parameterNames with
+    // getBoundAutomationVal(i, ...) instead of looking it up by name every block. Subclasses index them with an enum.
+    void bindParameters(const std::vector<std::string>& parameterNames);
+
+    float getBoundAutomationVal(int index, long long int sampleIndex) { return myBoundParameters[index]->sample((size_t)sampleIndex); }
+
+    std::vector<AutomateParameterFloat*> myBoundParameters;
+
+    std::vector<int> myInputChannelCounts;
+
+    std::shared_ptr<const TempoMap> myTempoMap = std::make_shared<TempoMap>();
+
+    // Read a MIDI file into midiBuffer with times in samples, or into midiSequenceQN with times in quarter notes if beats is true.
+    bool readMidiFile(const std::string& path, bool beats, double sampleRate, juce::MidiBuffer& midiBuffer, juce::MidiMessageSequence& midiSequenceQN);
+
+    // Fill mergedMidiBuffer with the events of midiBuffer and the events of midiSequenceQN converted to samples with the tempo map.
+    void mergeMidi(const juce::MidiBuffer& midiBuffer, const juce::MidiMessageSequence& midiSequenceQN, juce::MidiBuffer& mergedMidiBuffer);
 };
\ No newline at end of file
@@ -23,4 +23,6 @@ public:
     void reset(){}
 
     const juce::String getName() const { return "RecorderProcessor"; }
+
+    bool canSkipWhenSilent() { return true; }
 };
\ No newline at end of file
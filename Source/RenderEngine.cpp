@@ -5,15 +5,18 @@ RenderEngine::RenderEngine(double sr, int bs) :
     mySampleRate{ sr },
     myBufferSize{ bs }
 {
-    myMainProcessorGraph.reset(new juce::AudioProcessorGraph());
-    myMainProcessorGraph->setNonRealtime(true);
-    myMainProcessorGraph->setPlayHead(this);
-    myRecordedSamples = std::vector<std::vector<float>>(myNumOutputAudioChans, std::vector<float>(0));
+    myThreadPool = std::make_unique<RenderThreadPool>(1);
 }
 
 RenderEngine::~RenderEngine()
 {
-    myMainProcessorGraph->releaseResources();
+    if (myIsStreaming) {
+        // An unfinished streaming render may still have files open on myFileWriterThread.
+        finishRender();
+    }
+    if (myOutputRecorder) {
+        myOutputRecorder->releaseResources();
+    }
 }
 
 bool
@@ -21,52 +24,56 @@ RenderEngine::loadGraph(DAG inDagNodes, int numInputAudioChans=2, int numOutputA
 
     bool success = true;
 
-    std::vector<DAGNode>* dagNodes = (std::vector<DAGNode>*) &inDagNodes;
+    if (myIsStreaming) {
+        // Finalize the files of an abandoned streaming render before its processors can leave the graph.
+        finishRender();
+    }
 
-    myMainProcessorGraph->clear();
+    const bool channelsChanged = numInputAudioChans != myNumInputAudioChans || numOutputAudioChans != myNumOutputAudioChans;
 
     myNumInputAudioChans = numInputAudioChans;
     myNumOutputAudioChans = numOutputAudioChans;
 
-    using AudioGraphIOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
-
-    myMidiInputNode = myMainProcessorGraph->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::midiInputNode));
-
-    juce::ReferenceCountedArray<juce::AudioProcessorGraph::Node> slots;
-    int nodeInt = 0;
-
-    std::unordered_map<std::string, int> uniqueNameToSlotIndex;
-
-    for (auto node : *dagNodes) {
-        auto processorBase = node.processorBase;
-        std::vector<std::string> inputs = node.inputs;
-
-        auto myNode = myMainProcessorGraph->addNode((std::unique_ptr<ProcessorBase>)processorBase);
+    // Rather than rebuilding everything, nodes that stay in the graph with the same number of
+    // inputs keep their buffers and aren't prepared again.
+    std::unordered_map<ProcessorBase*, ScheduledNode> previousNodes;
+    for (auto& node : myNodes) {
+        auto processor = node.processor.get();
+        previousNodes[processor] = std::move(node);
+    }
+    myNodes.clear();
+    myLevels.clear();
 
-        // todo: does incReferenceCount() cause memory leak??
-        // If we don't do it, later calls to this function to load a new graph crash at
-        // myMainProcessorGraph->clear();
-        myNode.get()->incReferenceCount();
+    auto takePreparedNode = [&](ProcessorBase* processor, int numInputChannels, int numOutputChannels, ScheduledNode& node) {
+        auto previous = previousNodes.find(processor);
+        if (previous == previousNodes.end()) {
+            return false;
+        }
+        bool isPrepared = !channelsChanged && previous->second.numInputChannels == numInputChannels &&
+            previous->second.numOutputChannels == numOutputChannels;
+        if (isPrepared) {
+            node = std::move(previous->second);
+        }
+        previousNodes.erase(previous);
+        return isPrepared;
+    };
 
-        slots.set(nodeInt, myNode);
-        //slots.getUnchecked(nodeInt)->getProcessor()->setNonRealtime(true); // assume processors are initialized in non-real-time mode.
-        slots.getUnchecked(nodeInt)->getProcessor()->setPlayConfigDetails(myNumOutputAudioChans *(int)(inputs.size()),
-            myNumOutputAudioChans,
-            mySampleRate, myBufferSize);
+    std::unordered_map<std::string, int> uniqueNameToNodeIndex;
+    std::vector<int> nodeLevels;
+    std::vector<bool> nodeNeedsPrepare;
 
-        if (processorBase->acceptsMidi()) {
-            // Connect MIDI.
-            // Assume the first node is the one that needs to receive MIDI.
-            myMainProcessorGraph->addConnection({ { myMidiInputNode->nodeID,  juce::AudioProcessorGraph::midiChannelIndex },
-                                            { slots.getUnchecked(nodeInt)->nodeID, juce::AudioProcessorGraph::midiChannelIndex } });
-        }
+    for (auto& dagNode : inDagNodes.nodes) {
+        auto& processorBase = dagNode.processorBase;
 
-        uniqueNameToSlotIndex[processorBase->getUniqueName()] = nodeInt;
+        std::vector<int> inputIndices;
+        std::vector<int> inputChannelCounts;
+        int numInputChannels = 0;
+        const int numOutputChannels = dagNode.numOutputChannels > 0 ? dagNode.numOutputChannels : myNumOutputAudioChans;
 
-        int inputIndex = 0;
-        for (const std::string inputName : inputs) {
+        int level = 0;
+        for (const std::string& inputName : dagNode.inputs) {
 
-            if (uniqueNameToSlotIndex.find(inputName) == uniqueNameToSlotIndex.end())
+            if (uniqueNameToNodeIndex.find(inputName) == uniqueNameToNodeIndex.end())
             {
                 std::cout << "Error connecting " << inputName << " to " << processorBase->getUniqueName() << ";" << std::endl;
                 std::cout << "You might need to place " << inputName << " earlier in the graph." << std::endl;
@@ -74,65 +81,331 @@ RenderEngine::loadGraph(DAG inDagNodes, int numInputAudioChans=2, int numOutputA
                 continue;
             }
 
-            int slotIndexOfInput = uniqueNameToSlotIndex[inputName];
+            int inputIndex = uniqueNameToNodeIndex[inputName];
+            inputIndices.push_back(inputIndex);
+            inputChannelCounts.push_back(myNodes.at(inputIndex).numOutputChannels);
+            numInputChannels += myNodes.at(inputIndex).numOutputChannels;
+            level = std::max(level, nodeLevels.at(inputIndex) + 1);
+        }
 
-            for (int channel = 0; channel < myNumOutputAudioChans; ++channel) {
-                int chanSource = channel;
-                int chanDest = inputIndex * myNumOutputAudioChans + channel;
-                bool result = myMainProcessorGraph->addConnection({ { slots.getUnchecked(slotIndexOfInput)->nodeID, chanSource },
-                                                { slots.getUnchecked(nodeInt)->nodeID, chanDest } });
-                if (!result) {
-                    std::cout << "Error connecting " << inputName << " " << chanSource << " to " << processorBase->getUniqueName() << " " << chanDest << std::endl;
-                    success = false;
-                }
-            }
+        ScheduledNode node;
+        bool isPrepared = takePreparedNode(processorBase.get(), numInputChannels, numOutputChannels, node);
+        node.processor = processorBase;
+        node.inputIndices = inputIndices;
+        node.numInputChannels = numInputChannels;
+        node.numOutputChannels = numOutputChannels;
 
-            inputIndex++;
+        if (!isPrepared) {
+            processorBase->setPlayConfigDetails(numInputChannels, numOutputChannels, mySampleRate, myBufferSize);
         }
+        processorBase->setInputChannelCounts(inputChannelCounts);
 
-        nodeInt++;
+        uniqueNameToNodeIndex[processorBase->getUniqueName()] = (int)myNodes.size();
+        nodeLevels.push_back(level);
+        nodeNeedsPrepare.push_back(!isPrepared);
+        myNodes.push_back(std::move(node));
     }
 
-    if (!slots.isEmpty()) {
+    if (!myNodes.empty()) {
 
-        auto lastNodeID = slots.getLast()->nodeID;
+        // The recorder passes through the channels of the last node.
+        const int numChannels = myNodes.back().numOutputChannels;
 
-        slots.set(nodeInt, myMainProcessorGraph->addNode(std::make_unique<RecorderProcessor>("_output_recorder")));
-        slots.getUnchecked(nodeInt)->getProcessor()->setPlayConfigDetails(myNumInputAudioChans,
-            myNumOutputAudioChans,
-            mySampleRate, myBufferSize);
-        slots.getUnchecked(nodeInt)->getProcessor()->prepareToPlay(mySampleRate, myBufferSize);
+        ScheduledNode node;
+        bool isPrepared = myOutputRecorder && takePreparedNode(myOutputRecorder.get(), numChannels, numChannels, node);
 
-        auto recorderNodeID = slots.getUnchecked(nodeInt)->nodeID;
+        if (!isPrepared) {
+            myOutputRecorder = std::make_shared<RecorderProcessor>("_output_recorder");
+            myOutputRecorder->setPlayConfigDetails(numChannels, numChannels, mySampleRate, myBufferSize);
+        }
 
-        for (int channel = 0; channel < myNumOutputAudioChans; ++channel)
-        {
-            bool result = myMainProcessorGraph->addConnection({ { lastNodeID, channel },
-                    { recorderNodeID, channel } });
-            if (!result) {
-                std::cout << "unable to connect to recorderNode" << std::endl;
-                success = false;
+        node.processor = myOutputRecorder;
+        node.inputIndices = { (int)myNodes.size() - 1 };
+        node.numInputChannels = numChannels;
+        node.numOutputChannels = numChannels;
+
+        nodeLevels.push_back(nodeLevels.back() + 1);
+        nodeNeedsPrepare.push_back(!isPrepared);
+        myNodes.push_back(std::move(node));
+    }
+    else {
+        myOutputRecorder = nullptr;
+    }
+
+    // Whatever is left was removed from the graph. Dropping the nodes releases the engine's
+    // references to their processors. Their files are closed, since their writers use this engine's thread.
+    for (auto& [processor, node] : previousNodes) {
+        processor->stopFileRecording();
+        processor->releaseResources();
+    }
+    previousNodes.clear();
+
+    // Compile before preparing, so that the load takes as long as the slowest DSP instead of all of them.
+    compileFaustProcessors();
+
+    for (size_t i = 0; i < myNodes.size(); i++) {
+        auto& node = myNodes.at(i);
+        auto& processor = node.processor;
+
+        // Some processors read the play head in prepareToPlay.
+        processor->setPlayHead(this);
+
+        if (nodeNeedsPrepare.at(i)) {
+            processor->enableAllBuses();
+
+            const int numChannels = std::max(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+            node.buffer.setSize(std::max({ numChannels, node.numInputChannels, node.numOutputChannels }), myBufferSize);
+
+            processor->prepareToPlay(mySampleRate, myBufferSize);
+        }
+
+        int level = nodeLevels.at(i);
+        if ((int)myLevels.size() <= level) {
+            myLevels.resize(level + 1);
+        }
+        myLevels.at(level).push_back((int)i);
+    }
+
+    return success;
+}
+
+void
+RenderEngine::compileFaustProcessors()
+{
+#ifdef BUILD_DAWDREAMER_FAUST
+    std::vector<FaustProcessor*> processors;
+    for (auto& node : myNodes) {
+        if (auto faustProcessor = dynamic_cast<FaustProcessor*>(node.processor.get())) {
+            faustProcessor->waitForCompile();
+            if (!faustProcessor->isCompiled() && !faustProcessor->code().empty()) {
+                processors.push_back(faustProcessor);
             }
         }
     }
 
-    for (auto node : myMainProcessorGraph->getNodes()) {
-        node->getProcessor()->enableAllBuses();
+    // Only the factories are compiled in parallel. The instances are made here, one at a time, because polyphonic
+    // instances register their voice groups in a list that every FaustProcessor shares.
+    std::vector<FaustFactories> factories(processors.size());
+    const int numThreads = std::min((int)processors.size(), std::max(1, (int)std::thread::hardware_concurrency()));
+    RenderThreadPool threadPool(numThreads);
+    threadPool.parallelFor((int)processors.size(), [&](int i) {
+        factories.at(i) = processors.at(i)->getFactories();
+    });
+
+    // Failures are reported by compileWithFactories, and the processors output silence as they do when reset fails to
+    // compile them.
+    for (size_t i = 0; i < processors.size(); i++) {
+        processors.at(i)->compileWithFactories(factories.at(i));
+    }
+#endif
+}
+
+void
+RenderEngine::processNode(ScheduledNode& node, int startSample, int numSamples) {
+
+    // Process the samples [startSample, startSample + numSamples) of the node's buffer
+    // through a buffer that refers to them, so nothing is allocated or copied.
+    juce::AudioSampleBuffer buffer(node.buffer.getArrayOfWritePointers(), node.buffer.getNumChannels(), startSample, numSamples);
+
+    if (mySkipSilence) {
+        const long long int position = myCurrentPositionInfo.timeInSamples;
+
+        bool inputsSilent = true;
+        for (int inputIndex : node.inputIndices) {
+            inputsSilent &= myNodes.at(inputIndex).isSilent;
+        }
+        if (!inputsSilent || node.processor->hasEventsBetween(position, position + numSamples)) {
+            node.lastActiveSample = position + numSamples;
+        }
+
+        // Once the inputs have been silent for longer than the processor's tail, its output is silent too.
+        // The tail end is compared in double precision, and an infinite tail never ends.
+        const double tailSeconds = node.processor->getTailLengthSeconds();
+        if (node.processor->canSkipWhenSilent() && std::isfinite(tailSeconds) &&
+            (double)position >= (double)node.lastActiveSample + std::ceil(tailSeconds * mySampleRate)) {
+            buffer.clear();
+            node.midiBuffer.clear();
+            // Record the silence without processing it.
+            node.processor->ProcessorBase::processBlock(buffer, node.midiBuffer);
+            node.isSilent = true;
+            node.isSkipped = true;
+            return;
+        }
+
+        if (node.isSkipped) {
+            // The tail decayed while the processor was skipped, so it starts again from silence.
+            node.processor->clearTail();
+            node.isSkipped = false;
+        }
+    }
+
+    // Lay out the inputs one after another, mirroring the channel connections
+    // that an AudioProcessorGraph would make.
+    int chan = 0;
+    for (int inputIndex : node.inputIndices) {
+        auto& input = myNodes.at(inputIndex);
+        auto& inputBuffer = input.buffer;
+        for (int inputChan = 0; inputChan < input.numOutputChannels && chan < buffer.getNumChannels(); inputChan++, chan++) {
+            buffer.copyFrom(chan, 0, inputBuffer, inputChan, startSample, numSamples);
+        }
+    }
+    for (; chan < buffer.getNumChannels(); chan++) {
+        buffer.clear(chan, 0, numSamples);
+    }
+
+    node.midiBuffer.clear();
+
+    if (myIsProfiled) {
+        auto start = std::chrono::steady_clock::now();
+        node.processor->processBlock(buffer, node.midiBuffer);
+        node.blockDurationNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    else {
+        node.processor->processBlock(buffer, node.midiBuffer);
+    }
+
+    if (mySkipSilence) {
+        // Tails of reverbs, compressors and filters never reach exactly zero, so below -120 dB counts as silence.
+        const float silenceThreshold = juce::Decibels::decibelsToGain(-120.f);
+        node.isSilent = true;
+        for (int outputChan = 0; outputChan < std::min(node.numOutputChannels, buffer.getNumChannels()); outputChan++) {
+            node.isSilent &= buffer.getMagnitude(outputChan, 0, numSamples) < silenceThreshold;
+        }
+    }
+}
+
+int
+RenderEngine::getSubBlockSize(int startSample) {
+
+    const int numSamplesLeft = myBufferSize - startSample;
+    if (myAutomationInterval <= 0 || myAutomatedParameters.empty()) {
+        return numSamplesLeft;
     }
 
-    myMainProcessorGraph->setPlayConfigDetails(myNumInputAudioChans,
-        myNumOutputAudioChans,
-        mySampleRate, myBufferSize);
+    // End the sub-block where the next automation change happens, but no sooner than the interval allows.
+    const size_t position = (size_t)(myCurrentPositionInfo.timeInSamples + startSample);
+    const size_t blockEnd = position + numSamplesLeft;
+    size_t nextChange = blockEnd;
+    for (auto parameter : myAutomatedParameters) {
+        nextChange = parameter->findNextChange(position + 1, nextChange);
+    }
+
+    return std::min(numSamplesLeft, std::max(myAutomationInterval, (int)(nextChange - position)));
+}
+
+bool
+RenderEngine::prepareRender(long long int numRenderedSamples, bool recordToMemory) {
+
+    bool success = true;
 
-    myMainProcessorGraph->prepareToPlay(mySampleRate, myBufferSize);
-    for (auto node : myMainProcessorGraph->getNodes()) {
-        node->getProcessor()->prepareToPlay(mySampleRate, myBufferSize);
-        node->getProcessor()->setPlayHead(this);
+    if (myIsStreaming) {
+        finishRender();
+    }
+
+    for (auto& node : myNodes) {
+        // Processors convert MIDI and automation timed in quarter notes when they're reset.
+        node.processor->setTempoMap(myTempoMap);
+        node.processor->reset();
+        node.processor->setPlayHead(this);
+    }
+
+    myCurrentPositionInfo.resetToDefault();
+
+    myCurrentPositionInfo.isPlaying = true;
+    myCurrentPositionInfo.isRecording = true;
+    myCurrentPositionInfo.isLooping = false;
+    setPosition(0);
+
+    myIsProfiled = myProfiling;
+    myBlockDurations.clear();
+
+    myAutomatedParameters.clear();
+
+    for (auto& node : myNodes) {
+        node.blockDurations.clear();
+        node.isSilent = false;
+        node.isSkipped = false;
+        node.lastActiveSample = 0;
+
+        for (auto processorParameter : node.processor->getParameters()) {
+            auto parameter = dynamic_cast<AutomateParameterFloat*>(processorParameter);
+            if (parameter && parameter->isAutomated()) {
+                myAutomatedParameters.push_back(parameter);
+            }
+        }
+
+        node.processor->setRecorderLength(recordToMemory ? (int)numRenderedSamples : 0);
+
+        if (!node.processor->getRecordFilePath().empty() && !myFileWriterThread.isThreadRunning()) {
+            myFileWriterThread.startThread();
+        }
+        success &= node.processor->startFileRecording(myFileWriterThread, mySampleRate, numRenderedSamples);
     }
 
     return success;
 }
 
+void
+RenderEngine::renderBlock() {
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto& node : myNodes) {
+        node.blockDurationNs = 0;
+    }
+
+    const long long int blockStart = myCurrentPositionInfo.timeInSamples;
+
+    int startSample = 0;
+    while (startSample < myBufferSize) {
+        const int numSamples = getSubBlockSize(startSample);
+
+        setPosition(blockStart + startSample);
+
+        // The nodes of a level only read the buffers of earlier levels,
+        // so they can be processed in any order and on any thread.
+        for (auto& level : myLevels) {
+            myThreadPool->parallelFor((int)level.size(), [&](int j) {
+                processNode(myNodes.at(level.at(j)), startSample, numSamples);
+            });
+        }
+
+        startSample += numSamples;
+    }
+
+    if (myIsProfiled) {
+        for (auto& node : myNodes) {
+            node.blockDurations.add(node.blockDurationNs);
+        }
+        myBlockDurations.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    setPosition(blockStart + myBufferSize);
+}
+
+void
+RenderEngine::setPosition(long long int timeInSamples) {
+
+    myCurrentPositionInfo.timeInSamples = timeInSamples;
+    myCurrentPositionInfo.timeInSeconds = (double)timeInSamples / mySampleRate;
+    myCurrentPositionInfo.ppqPosition = myTempoMap->secondsToPPQ(myCurrentPositionInfo.timeInSeconds);
+    myCurrentPositionInfo.bpm = myTempoMap->getBPM(myCurrentPositionInfo.ppqPosition);
+
+    auto& timeSignature = myTempoMap->getTimeSignature(myCurrentPositionInfo.ppqPosition, myCurrentPositionInfo.ppqPositionOfLastBarStart);
+    myCurrentPositionInfo.timeSigNumerator = timeSignature.numerator;
+    myCurrentPositionInfo.timeSigDenominator = timeSignature.denominator;
+}
+
+void
+RenderEngine::finishRender() {
+    myIsStreaming = false;
+    for (auto& node : myNodes) {
+        node.processor->stopFileRecording();
+    }
+    myCurrentPositionInfo.isPlaying = false;
+    myCurrentPositionInfo.isRecording = false;
+}
+
 void
 RenderEngine::render(const double renderLength) {
 
@@ -144,45 +417,291 @@ RenderEngine::render(const double renderLength) {
 
     int numberOfBuffers = int(std::ceil((numRenderedSamples -1.) / myBufferSize));
 
-    AudioSampleBuffer audioBuffer(myNumOutputAudioChans, myBufferSize);
+    prepareRender(numRenderedSamples, true);
 
-    // Clear main buffer and prepare to record samples over multiple buffer passes.
-    myRecordedSamples.clear();
-    myRecordedSamples = std::vector<std::vector<float>>(myNumOutputAudioChans, std::vector<float>(numRenderedSamples, 0.f));
+    for (long long int i = 0; i < numberOfBuffers; ++i)
+    {
+        renderBlock();
+    }
 
-    myMainProcessorGraph->reset();
-    myMainProcessorGraph->setPlayHead(this);
+    finishRender();
+}
 
-    myCurrentPositionInfo.resetToDefault();
+long long int
+RenderEngine::renderUntilSilent(const double maxRenderLength, const double thresholdDB, const int numSilentBlocks) {
 
-    myCurrentPositionInfo.bpm = myBPM;
-    myCurrentPositionInfo.isPlaying = true;
-    myCurrentPositionInfo.isRecording = true;
-    myCurrentPositionInfo.timeInSamples = 0;
-    myCurrentPositionInfo.timeSigNumerator = 4;
-    myCurrentPositionInfo.timeSigDenominator = 4;
-    myCurrentPositionInfo.isLooping = false;
+    const long long int maxNumSamples = (long long int)(maxRenderLength * mySampleRate);
+    if (maxNumSamples <= 0) {
+        std::cerr << "Render length must be greater than zero." << std::endl;
+        return 0;
+    }
+    if (maxNumSamples > std::numeric_limits<int>::max()) {
+        // Recordings in memory are indexed by int.
+        std::cerr << "Render length must be at most " << std::numeric_limits<int>::max() << " samples." << std::endl;
+        return 0;
+    }
 
-    for (int i = 0; i < myMainProcessorGraph->getNumNodes(); i++) {
-        auto processor = dynamic_cast<ProcessorBase*> (myMainProcessorGraph->getNode(i)->getProcessor());
-        if (processor) {
-            processor->setRecorderLength(numRenderedSamples);
+    if (myNodes.empty()) {
+        std::cerr << "A graph must be loaded before rendering." << std::endl;
+        return 0;
+    }
+
+    // Processors have merged their MIDI and received the tempo map once the render is prepared.
+    prepareRender(maxNumSamples, true);
+
+    long long int lastEventSample = 0;
+    double tailSeconds = 0.;
+    for (auto& node : myNodes) {
+        lastEventSample = std::max(lastEventSample, node.processor->getLastEventSample());
+        // Plugins report an infinite tail as infinity. The threshold decides when such a tail has ended.
+        const double processorTailSeconds = node.processor->getTailLengthSeconds();
+        if (std::isfinite(processorTailSeconds)) {
+            tailSeconds = std::max(tailSeconds, processorTailSeconds);
         }
     }
+    // Add in double precision, so that a huge tail can't overflow.
+    const long long int silenceStart = (long long int)std::min((double)maxNumSamples,
+        (double)lastEventSample + std::ceil(tailSeconds * mySampleRate));
 
-    MidiBuffer renderMidiBuffer;
+    const float threshold = juce::Decibels::decibelsToGain((float)thresholdDB, -1000.f);
+    auto& outputBuffer = myNodes.back().buffer;
 
-    for (long long int i = 0; i < numberOfBuffers; ++i)
-    {
-        // This gets RecorderProcessor to write to this RenderEngine's myRecordedSamples.
-        myMainProcessorGraph->processBlock(audioBuffer, renderMidiBuffer);
+    long long int numRenderedSamples = 0;
+    int numSilent = 0;
+
+    while (numRenderedSamples < maxNumSamples && numSilent < std::max(1, numSilentBlocks)) {
+        renderBlock();
+        numRenderedSamples += myBufferSize;
+
+        if (numRenderedSamples <= silenceStart) {
+            continue;
+        }
 
-        myCurrentPositionInfo.timeInSamples += myBufferSize;
-        myCurrentPositionInfo.ppqPosition = (myCurrentPositionInfo.timeInSamples / (mySampleRate * 60.)) * myBPM;
+        float magnitude = 0.f;
+        for (int chan = 0; chan < getNumOutputChannels(); chan++) {
+            magnitude = std::max(magnitude, outputBuffer.getMagnitude(chan, 0, myBufferSize));
+        }
+        numSilent = magnitude < threshold ? numSilent + 1 : 0;
     }
 
-    myCurrentPositionInfo.isPlaying = false;
-    myCurrentPositionInfo.isRecording = false;
+    finishRender();
+
+    numRenderedSamples = std::min(numRenderedSamples, maxNumSamples);
+    for (auto& node : myNodes) {
+        node.processor->trimRecording((int)numRenderedSamples);
+    }
+
+    return numRenderedSamples;
+}
+
+namespace {
+
+// A private copy of the graph that renders the variants of a batch on one thread.
+class BatchWorker {
+public:
+    std::unordered_map<std::string, ProcessorBase*> processorsByName;
+    std::unique_ptr<RenderEngine> engine;
+};
+
+}
+
+bool
+RenderEngine::renderBatch(const std::vector<ParameterSet>& parameterSets, const double renderLength, int numThreads, float* output) {
+
+    const long long int numRenderedSamples = (long long int)(renderLength * mySampleRate);
+    if (numRenderedSamples <= 0) {
+        std::cerr << "Render length must be greater than zero." << std::endl;
+        return false;
+    }
+
+    if (myNodes.empty()) {
+        std::cerr << "A graph must be loaded before rendering." << std::endl;
+        return false;
+    }
+
+    if (parameterSets.empty()) {
+        return true;
+    }
+
+    // The last node is the output recorder, which every worker engine makes for itself.
+    const int numProcessors = (int)myNodes.size() - 1;
+
+    std::unordered_map<std::string, ProcessorBase*> processorsByName;
+    for (int i = 0; i < numProcessors; i++) {
+        processorsByName[myNodes.at(i).processor->getUniqueName()] = myNodes.at(i).processor.get();
+    }
+
+    for (auto& parameterSet : parameterSets) {
+        for (auto& [processorName, parameters] : parameterSet) {
+            auto it = processorsByName.find(processorName);
+            if (it == processorsByName.end()) {
+                std::cerr << "Error: render_batch. There is no processor named " << processorName << " in the graph." << std::endl;
+                return false;
+            }
+            for (auto& [parameterName, values] : parameters) {
+                if (!it->second->hasParameter(parameterName) || values.empty()) {
+                    std::cerr << "Error: render_batch. Unable to set " << parameterName << " of " << processorName << "." << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    if (numThreads <= 0) {
+        numThreads = juce::SystemStats::getNumCpus();
+    }
+    const int numWorkers = std::min(numThreads, (int)parameterSets.size());
+
+    // Clone the graph once per worker. Every variant a worker renders reuses its clones,
+    // which are owned by the worker's engine.
+    std::vector<BatchWorker> workers(numWorkers);
+    for (auto& worker : workers) {
+        DAG dag;
+        for (int i = 0; i < numProcessors; i++) {
+            auto& original = myNodes.at(i).processor;
+            std::shared_ptr<ProcessorBase> processor(original->clone(original->getUniqueName()));
+            if (!processor) {
+                std::cerr << "Error: render_batch. Unable to clone " << original->getUniqueName() << "." << std::endl;
+                return false;
+            }
+
+            DAGNode dagNode;
+            dagNode.processorBase = processor;
+            dagNode.numOutputChannels = myNodes.at(i).numOutputChannels;
+            for (int inputIndex : myNodes.at(i).inputIndices) {
+                dagNode.inputs.push_back(myNodes.at(inputIndex).processor->getUniqueName());
+            }
+            dag.nodes.push_back(dagNode);
+
+            worker.processorsByName[original->getUniqueName()] = processor.get();
+        }
+
+        worker.engine = std::make_unique<RenderEngine>(mySampleRate, myBufferSize);
+        worker.engine->myTempoMap = myTempoMap;
+        worker.engine->setAutomationInterval(myAutomationInterval);
+        worker.engine->setSkipSilence(mySkipSilence);
+        if (!worker.engine->loadGraph(dag, myNumInputAudioChans, myNumOutputAudioChans)) {
+            return false;
+        }
+    }
+
+    const int numOutputChannels = getNumOutputChannels();
+    const size_t numSamplesPerRender = (size_t)numOutputChannels * (size_t)numRenderedSamples;
+    std::atomic<int> nextRender{ 0 };
+
+    RenderThreadPool threadPool(numWorkers);
+    threadPool.parallelFor(numWorkers, [&](int workerIndex) {
+        auto& worker = workers.at(workerIndex);
+
+        int renderIndex;
+        while ((renderIndex = nextRender.fetch_add(1)) < (int)parameterSets.size()) {
+            auto& parameterSet = parameterSets.at(renderIndex);
+
+            for (auto& [processorName, parameters] : parameterSet) {
+                auto processor = worker.processorsByName.at(processorName);
+                for (auto& [parameterName, values] : parameters) {
+                    processor->setAutomationValues(parameterName, values);
+                }
+            }
+
+            worker.engine->render(renderLength);
+
+            auto& recording = worker.engine->myOutputRecorder->getRecordBuffer();
+            const int numSamples = (int)std::min((long long int)recording.getNumSamples(), numRenderedSamples);
+            float* renderOutput = output + renderIndex * numSamplesPerRender;
+            for (int chan = 0; chan < numOutputChannels; chan++) {
+                float* channelOutput = renderOutput + chan * numRenderedSamples;
+                std::fill(channelOutput, channelOutput + numRenderedSamples, 0.f);
+                if (chan < recording.getNumChannels()) {
+                    std::memcpy(channelOutput, recording.getReadPointer(chan), numSamples * sizeof(float));
+                }
+            }
+
+            // Put back the automation of the original graph before the next variant.
+            for (auto& [processorName, parameters] : parameterSet) {
+                worker.processorsByName.at(processorName)->copyAutomationFrom(*processorsByName.at(processorName));
+            }
+        }
+    });
+
+    return true;
+}
+
+bool
+RenderEngine::startStreamingRender(const double renderLength, const double chunkLength) {
+
+    long long int numRenderedSamples = (long long int)(renderLength * mySampleRate);
+    int chunkSize = int(chunkLength * mySampleRate);
+    if (numRenderedSamples <= 0 || chunkSize <= 0) {
+        std::cerr << "Render length and chunk length must be greater than zero." << std::endl;
+        return false;
+    }
+
+    if (myNodes.empty()) {
+        std::cerr << "A graph must be loaded before rendering." << std::endl;
+        return false;
+    }
+
+    // Nothing is recorded in memory, so memory stays bounded by the chunk size.
+    prepareRender(numRenderedSamples, false);
+
+    myStreamNumSamples = numRenderedSamples;
+    myStreamNumSamplesReturned = 0;
+    myStreamChunkSize = chunkSize;
+    myStreamPending.setSize(getNumOutputChannels(), chunkSize + myBufferSize);
+    myStreamNumPending = 0;
+    myIsStreaming = true;
+
+    return true;
+}
+
+int
+RenderEngine::getNextChunkSize() {
+    if (!myIsStreaming) {
+        return 0;
+    }
+    return (int)std::min((long long int)myStreamChunkSize, myStreamNumSamples - myStreamNumSamplesReturned);
+}
+
+bool
+RenderEngine::renderNextChunk(juce::AudioSampleBuffer& chunk) {
+
+    const int chunkSize = getNextChunkSize();
+    if (chunkSize <= 0) {
+        finishRender();
+        return false;
+    }
+
+    const int numChannels = myStreamPending.getNumChannels();
+    auto& outputBuffer = myNodes.back().buffer;
+
+    while (myStreamNumPending < chunkSize) {
+        renderBlock();
+        for (int chan = 0; chan < numChannels; chan++) {
+            myStreamPending.copyFrom(chan, myStreamNumPending, outputBuffer, chan, 0, myBufferSize);
+        }
+        myStreamNumPending += myBufferSize;
+    }
+
+    // Hand out one chunk and keep the rest of the last block for the next chunk.
+    const int numLeftOver = myStreamNumPending - chunkSize;
+    jassert(chunk.getNumChannels() == numChannels);
+    for (int chan = 0; chan < numChannels; chan++) {
+        if (chan < chunk.getNumChannels()) {
+            chunk.copyFrom(chan, 0, myStreamPending, chan, 0, chunkSize);
+        }
+        // Every pending channel moves along, even one that the chunk has no room for.
+        auto pendingPtr = myStreamPending.getWritePointer(chan);
+        std::memmove(pendingPtr, pendingPtr + chunkSize, numLeftOver * sizeof(float));
+    }
+    myStreamNumPending = numLeftOver;
+    myStreamNumSamplesReturned += chunkSize;
+
+    if (myStreamNumSamplesReturned >= myStreamNumSamples) {
+        finishRender();
+    }
+
+    return true;
 }
 
 void RenderEngine::setBPM(double bpm) {
@@ -190,21 +709,66 @@ void RenderEngine::setBPM(double bpm) {
         std::cerr << "BPM must be positive.";
         return;
     }
-    myBPM = bpm;
+    setTempoMap({ { 0., bpm, false } });
 }
 
-py::array_t<float>
-RenderEngine::getAudioFrames()
-{
+bool RenderEngine::setTempoMap(const std::vector<TempoChange>& tempos) {
+    // Maps are shared with processors and batch workers, so a change makes a new map.
+    auto tempoMap = std::make_shared<TempoMap>(*myTempoMap);
+    if (!tempoMap->setTempos(tempos)) {
+        return false;
+    }
+    myTempoMap = tempoMap;
+    return true;
+}
 
-    auto nodes = myMainProcessorGraph->getNodes();
-    for (auto& node: nodes) {
+bool RenderEngine::setTimeSignatures(const std::vector<TimeSignatureChange>& timeSignatures) {
+    auto tempoMap = std::make_shared<TempoMap>(*myTempoMap);
+    if (!tempoMap->setTimeSignatures(timeSignatures)) {
+        return false;
+    }
+    myTempoMap = tempoMap;
+    return true;
+}
 
-        auto processor = dynamic_cast<RecorderProcessor*>(node->getProcessor());
-        if (processor) {
-            return processor->getAudioFrames();
-        }
+void RenderEngine::setNumThreads(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = juce::SystemStats::getNumCpus();
+    }
+    if (numThreads != myThreadPool->getNumThreads()) {
+        myThreadPool = std::make_unique<RenderThreadPool>(numThreads);
+    }
+}
+
+int RenderEngine::getNumOutputChannels() {
+    return myNodes.empty() ? myNumOutputAudioChans : myNodes.back().numOutputChannels;
+}
 
+int RenderEngine::getNumThreads() {
+    return myThreadPool->getNumThreads();
+}
+
+void RenderEngine::setAutomationInterval(int numSamples) {
+    myAutomationInterval = std::max(0, numSamples);
+}
+
+int RenderEngine::getAutomationInterval() {
+    return myAutomationInterval;
+}
+
+void RenderEngine::setSkipSilence(bool skipSilence) {
+    mySkipSilence = skipSilence;
+}
+
+bool RenderEngine::getSkipSilence() {
+    return mySkipSilence;
+}
+
+py::array
+RenderEngine::getAudioFrames()
+{
+    if (myOutputRecorder) {
+        return myOutputRecorder->getAudioFrames();
     }
 
     // NB: For some reason we can't initialize the array as shape (2, 0)
@@ -214,18 +778,12 @@ RenderEngine::getAudioFrames()
     return arr;
 }
 
-py::array_t<float>
+py::array
 RenderEngine::getAudioFramesForName(std::string& name)
 {
-
-    auto nodes = myMainProcessorGraph->getNodes();
-    for (auto& node : nodes) {
-
-        auto processor = dynamic_cast<ProcessorBase*>(node->getProcessor());
-        if (processor) {
-            if (std::strcmp(processor->getUniqueName().c_str(), name.c_str()) == 0) {
-                return processor->getAudioFrames();
-            }
+    for (auto& node : myNodes) {
+        if (std::strcmp(node.processor->getUniqueName().c_str(), name.c_str()) == 0) {
+            return node.processor->getAudioFrames();
         }
     }
 
@@ -237,6 +795,122 @@ RenderEngine::getAudioFramesForName(std::string& name)
 }
 
 
+void
+DurationHistogram::clear() {
+    myCount = 0;
+    myTotalNs = 0;
+    myMaxNs = 0;
+    myBuckets.fill(0);
+}
+
+void
+DurationHistogram::add(juce::int64 durationNs) {
+    durationNs = std::max((juce::int64)0, durationNs);
+    myCount++;
+    myTotalNs += durationNs;
+    myMaxNs = std::max(myMaxNs, durationNs);
+    myBuckets.at(getBucket(durationNs))++;
+}
+
+int
+DurationHistogram::getBucket(juce::int64 durationNs) {
+    // Durations below numBucketsPerOctave have a bucket each. Above, an octave [2^k, 2^(k+1)) is split into
+    // numBucketsPerOctave buckets by the bits that follow the highest set bit.
+    if (durationNs < numBucketsPerOctave) {
+        return (int)durationNs;
+    }
+    int octave = 3;
+    while ((durationNs >> (octave + 1)) != 0) {
+        octave++;
+    }
+    const int subBucket = (int)((durationNs >> (octave - 3)) & (numBucketsPerOctave - 1));
+    return numBucketsPerOctave * (octave - 2) + subBucket;
+}
+
+juce::int64
+DurationHistogram::getBucketEnd(int bucket) {
+    if (bucket < numBucketsPerOctave) {
+        return (juce::int64)bucket;
+    }
+    const int octave = bucket / numBucketsPerOctave + 2;
+    const juce::int64 subBucket = bucket % numBucketsPerOctave;
+    const juce::int64 width = (juce::int64)1 << (octave - 3);
+    return ((numBucketsPerOctave + subBucket) << (octave - 3)) + (width - 1);
+}
+
+ProfileStats
+DurationHistogram::summarize(const std::string& name) const {
+
+    ProfileStats stats;
+    stats.name = name;
+    stats.blocks = myCount;
+    stats.totalNs = myTotalNs;
+    stats.maxNs = myMaxNs;
+    stats.meanNs = myCount == 0 ? 0. : (double)myTotalNs / (double)myCount;
+
+    if (myCount > 0) {
+        const juce::int64 rank = (juce::int64)std::ceil(.99 * (double)myCount);
+        juce::int64 numBelow = 0;
+        for (int bucket = 0; bucket < numBuckets; bucket++) {
+            numBelow += myBuckets.at(bucket);
+            if (numBelow >= rank) {
+                stats.p99Ns = std::min(getBucketEnd(bucket), myMaxNs);
+                break;
+            }
+        }
+    }
+
+    return stats;
+}
+
+void
+RenderEngine::setProfiling(bool profiling) {
+    myProfiling = profiling;
+}
+
+bool
+RenderEngine::getProfiling() {
+    return myProfiling;
+}
+
+std::vector<ProfileStats>
+RenderEngine::getProfileStats()
+{
+    std::vector<ProfileStats> profile;
+    if (!myIsProfiled) {
+        return profile;
+    }
+
+    for (auto& node : myNodes) {
+        if (node.processor == myOutputRecorder) {
+            continue;
+        }
+        profile.push_back(node.blockDurations.summarize(node.processor->getUniqueName()));
+    }
+
+    profile.push_back(myBlockDurations.summarize("_render"));
+
+    return profile;
+}
+
+py::dict
+RenderEngine::getProfile()
+{
+    py::dict profile;
+
+    for (auto& stats : getProfileStats()) {
+        py::dict summary;
+        summary["total_ns"] = stats.totalNs;
+        summary["mean_ns"] = stats.meanNs;
+        summary["max_ns"] = stats.maxNs;
+        summary["p99_ns"] = stats.p99Ns;
+        summary["blocks"] = stats.blocks;
+        profile[py::str(stats.name)] = summary;
+    }
+
+    return profile;
+}
+
 bool
 RenderEngine::getCurrentPosition(CurrentPositionInfo& result) {
     result = myCurrentPositionInfo;
@@ -5,13 +5,18 @@
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <map>
+#include <chrono>
 
 #include "AllProcessors.h"
+#include "RenderThreadPool.h"
 
 class DAGNode {
 public:
-    ProcessorBase* processorBase;
+    std::shared_ptr<ProcessorBase> processorBase;
     std::vector<std::string> inputs;
+    // The number of channels the processor outputs, or 0 for the engine's number of output channels.
+    int numOutputChannels = 0;
 };
 
 class DAG {
@@ -19,6 +24,64 @@ public:
     std::vector<DAGNode> nodes;
 };
 
+// Timings of one processor's processBlock calls during a render, in nanoseconds per block.
+class ProfileStats {
+public:
+    std::string name;
+    juce::int64 totalNs = 0;
+    double meanNs = 0.;
+    juce::int64 maxNs = 0;
+    juce::int64 p99Ns = 0;
+    juce::int64 blocks = 0;
+};
+
+// Block durations in nanoseconds, counted in buckets an eighth of an octave wide, so that the memory of a profile
+// doesn't grow with the length of the render. The p99 is the upper edge of its bucket, which is at most 12.5% high.
+class DurationHistogram {
+public:
+    void clear();
+    void add(juce::int64 durationNs);
+    ProfileStats summarize(const std::string& name) const;
+
+private:
+    static constexpr int numBucketsPerOctave = 8;
+    static constexpr int numBuckets = numBucketsPerOctave * 61;
+
+    static int getBucket(juce::int64 durationNs);
+    static juce::int64 getBucketEnd(int bucket);
+
+    juce::int64 myCount = 0;
+    juce::int64 myTotalNs = 0;
+    juce::int64 myMaxNs = 0;
+    std::array<juce::int64, numBuckets> myBuckets{};
+};
+
+// A processor as scheduled by the RenderEngine. Its buffer holds the concatenated
+// outputs of its inputs before processBlock and its own output afterwards.
+// The engine shares ownership of the processor while it's in the graph.
+class ScheduledNode {
+public:
+    std::shared_ptr<ProcessorBase> processor;
+    std::vector<int> inputIndices;
+    // The sum of the output channels of the inputs, and the number of channels this node outputs.
+    int numInputChannels = 0;
+    int numOutputChannels = 0;
+    juce::AudioSampleBuffer buffer;
+    juce::MidiBuffer midiBuffer;
+    // Nanoseconds spent in processBlock per block of the most recent profiled render, and in the current block.
+    DurationHistogram blockDurations;
+    juce::int64 blockDurationNs = 0;
+    // Whether the most recent output of the processor was below the silence threshold, and whether processBlock
+    // was skipped for it. Only tracked when skipping silence.
+    bool isSilent = false;
+    bool isSkipped = false;
+    // The sample after the last one at which the processor had sound in its inputs or events.
+    long long int lastActiveSample = 0;
+};
+
+// The automation of one variant in a batch render: processor name -> parameter name -> automation.
+typedef std::map<std::string, std::map<std::string, std::vector<float>>> ParameterSet;
+
 class RenderEngine : AudioPlayHead
 {
 public:
@@ -26,15 +89,63 @@ public:
     ~RenderEngine();
     // RenderEngine(const RenderEngine&) = delete;
 
+    // Every node outputs numOutputAudioChans channels unless its DAGNode declares otherwise, and a node's inputs
+    // are laid out one after another. The engine outputs the channels of the last node.
     bool loadGraph(DAG dagNodes, int numInputAudioChans, int numOutputAudioChans);
-    
+
+    // The number of channels of the output of the loaded graph.
+    int getNumOutputChannels();
+
     void render (const double renderLength);
 
+    // Render until the output stays below thresholdDB for numSilentBlocks blocks, counting only blocks after
+    // the last MIDI event, automation change and the longest processor tail, or until maxRenderLength.
+    // Recordings are trimmed to the rendered length, which is returned in samples.
+    long long int renderUntilSilent(const double maxRenderLength, const double thresholdDB, const int numSilentBlocks);
+
+    // Render the loaded graph once per parameter set. The graph is cloned into numThreads
+    // worker engines that render the variants concurrently, so the graph itself is left untouched.
+    // output receives one (numOutputAudioChans, renderLength * sampleRate) render per parameter set.
+    bool renderBatch(const std::vector<ParameterSet>& parameterSets, const double renderLength, int numThreads, float* output);
+
+    // Streaming render: start it, then call renderNextChunk until it returns false. The chunk must have
+    // getNumOutputChannels() channels and at least getNextChunkSize() samples.
+    // Processors don't record to memory during a streaming render, so memory doesn't grow with its length.
+    bool startStreamingRender(const double renderLength, const double chunkLength);
+    int getNextChunkSize();
+    bool renderNextChunk(juce::AudioSampleBuffer& chunk);
+
+    // A constant tempo. It replaces the tempo map but keeps the time signatures.
     void setBPM(double bpm);
 
-    py::array_t<float> getAudioFrames();
+    // Tempo changes at positions in quarter notes. The first must be at 0.
+    bool setTempoMap(const std::vector<TempoChange>& tempos);
+    bool setTimeSignatures(const std::vector<TimeSignatureChange>& timeSignatures);
+
+    void setNumThreads(int numThreads);
+    int getNumThreads();
+
+    // With an interval of N > 0, blocks are split into sub-blocks wherever automation changes value,
+    // so processors see new automation values within a block. Sub-blocks are at least N samples long
+    // unless they end the block. With 0, automation is read once per block.
+    void setAutomationInterval(int numSamples);
+    int getAutomationInterval();
 
-    py::array_t<float> getAudioFramesForName(std::string& name);
+    void setSkipSilence(bool skipSilence);
+    bool getSkipSilence();
+
+    py::array getAudioFrames();
+
+    py::array getAudioFramesForName(std::string& name);
+
+    // Whether renders time every processor's blocks. The default is false.
+    void setProfiling(bool profiling);
+    bool getProfiling();
+
+    // Timings of the most recent render for every processor, and for whole blocks under "_render".
+    // Empty unless profiling was enabled for that render.
+    std::vector<ProfileStats> getProfileStats();
+    py::dict getProfile();
 
     bool getCurrentPosition(CurrentPositionInfo& result) override;
     bool canControlTransport() override;
@@ -46,19 +157,62 @@ protected:
 
     double mySampleRate;
     int myBufferSize;
-    double myBPM = 120.;
+    std::shared_ptr<const TempoMap> myTempoMap = std::make_shared<TempoMap>();
+
+    int myNumInputAudioChans = 2;
+    int myNumOutputAudioChans = 2;
 
 private:
-                           
-    std::vector<std::vector<float>> myRecordedSamples;
 
-    std::unique_ptr<juce::AudioProcessorGraph> myMainProcessorGraph;
+    // Nodes in the order they were given to loadGraph, followed by the output recorder.
+    std::vector<ScheduledNode> myNodes;
 
-    juce::AudioProcessorGraph::Node::Ptr myMidiInputNode;
+    // myLevels[i] holds the indices of nodes whose inputs all belong to earlier levels,
+    // so the nodes of one level can be processed concurrently.
+    std::vector<std::vector<int>> myLevels;
 
-    int myNumInputAudioChans = 2;
-    int myNumOutputAudioChans = 2;
+    std::shared_ptr<RecorderProcessor> myOutputRecorder;
+
+    int myAutomationInterval = 0;
+
+    bool mySkipSilence = false;
+
+    // The parameters whose automation changes during the current render.
+    std::vector<AutomateParameterFloat*> myAutomatedParameters;
+
+    std::unique_ptr<RenderThreadPool> myThreadPool;
+
+    // Drains the FIFOs of processors that record to files.
+    juce::TimeSliceThread myFileWriterThread{ "DawDreamer file writer" };
+
+    bool myIsStreaming = false;
+    long long int myStreamNumSamples = 0;
+    long long int myStreamNumSamplesReturned = 0;
+    int myStreamChunkSize = 0;
+    // Output samples rendered beyond the last returned chunk.
+    juce::AudioSampleBuffer myStreamPending;
+    int myStreamNumPending = 0;
 
     CurrentPositionInfo myCurrentPositionInfo;
 
+    bool myProfiling = false;
+    // Whether profiling was enabled for the most recent render.
+    bool myIsProfiled = false;
+    // Nanoseconds spent rendering each block of the most recent profiled render.
+    DurationHistogram myBlockDurations;
+
+    void processNode(ScheduledNode& node, int startSample, int numSamples);
+
+    // Compile the graph's Faust processors that aren't compiled yet, several at a time.
+    void compileFaustProcessors();
+
+    int getSubBlockSize(int startSample);
+
+    // Move the play head, looking up the tempo and time signature in the tempo map.
+    void setPosition(long long int timeInSamples);
+
+    bool prepareRender(long long int numRenderedSamples, bool recordToMemory);
+    void renderBlock();
+    void finishRender();
+
 };
@@ -109,7 +109,7 @@ RenderEngineWrapper::loadGraphWrapper(py::object dagObj, int numInputAudioChans
         return false;
     }
 
-    DAG* buildingDag = new DAG();
+    DAG buildingDag;
 
     for (py::handle theTuple : dagObj) {  // iterators!
 
@@ -119,8 +119,8 @@ RenderEngineWrapper::loadGraphWrapper(py::object dagObj, int numInputAudioChans
         }
         py::list castedTuple = theTuple.cast<py::list>();
 
-        if (castedTuple.size() != 2) {
-            std::cout << "Error: load_graph. Each tuple in the graph must be size 2." << std::endl;
+        if (castedTuple.size() != 2 && castedTuple.size() != 3) {
+            std::cout << "Error: load_graph. Each tuple in the graph must be size 2 or 3." << std::endl;
             return false;
         }
 
@@ -148,7 +148,7 @@ RenderEngineWrapper::loadGraphWrapper(py::object dagObj, int numInputAudioChans
 
         DAGNode dagNode;
         try {
-            dagNode.processorBase = castedTuple[0].cast<ProcessorBase*>();
+            dagNode.processorBase = castedTuple[0].cast<std::shared_ptr<ProcessorBase>>();
         }
         catch (std::exception&) {
             std::cout << "Error: load_graph. First argument in tuple wasn't a Processor object." << std::endl;
@@ -157,8 +157,132 @@ RenderEngineWrapper::loadGraphWrapper(py::object dagObj, int numInputAudioChans
 
         dagNode.inputs = inputs;
 
-        buildingDag->nodes.push_back(dagNode);
+        if (castedTuple.size() == 3) {
+            if (!py::isinstance<py::int_>(castedTuple[2]) || castedTuple[2].cast<int>() <= 0) {
+                std::cout << "Error: load_graph. The number of output channels must be a positive integer." << std::endl;
+                return false;
+            }
+            dagNode.numOutputChannels = castedTuple[2].cast<int>();
+        }
+
+        buildingDag.nodes.push_back(dagNode);
+    }
+
+    return RenderEngine::loadGraph(buildingDag, numInputAudioChans, numOutputAudioChans);
+}
+
+py::array_t<float>
+RenderEngineWrapper::renderBatchWrapper(py::list parameterSetsList, double renderLength, int numThreads) {
+
+    // Convert everything to C++ types first so that the render doesn't need the GIL.
+    std::vector<ParameterSet> parameterSets;
+
+    for (py::handle potentialDict : parameterSetsList) {
+        if (!py::isinstance<py::dict>(potentialDict)) {
+            throw std::invalid_argument("Each parameter set must be a dictionary of processor names to dictionaries of parameters.");
+        }
+
+        ParameterSet parameterSet;
+
+        for (auto&& [processorName, potentialParameters] : potentialDict.cast<py::dict>()) {
+            if (!py::isinstance<py::str>(processorName) || !py::isinstance<py::dict>(potentialParameters)) {
+                throw std::invalid_argument("Each parameter set must be a dictionary of processor names to dictionaries of parameters.");
+            }
+
+            auto& parameters = parameterSet[processorName.cast<std::string>()];
+
+            for (auto&& [parameterName, value] : potentialParameters.cast<py::dict>()) {
+                if (!py::isinstance<py::str>(parameterName)) {
+                    throw std::invalid_argument("Parameter names must be strings.");
+                }
+
+                // A single value or an array of automation, like set_automation.
+                auto values = value.cast<py::array_t<float, py::array::c_style | py::array::forcecast>>();
+                parameters[parameterName.cast<std::string>()] = std::vector<float>(values.data(), values.data() + values.size());
+            }
+        }
+
+        parameterSets.push_back(parameterSet);
+    }
+
+    const int numSamples = int(renderLength * mySampleRate);
+
+    py::array_t<float, py::array::c_style> arr({ (int)parameterSets.size(), getNumOutputChannels(), std::max(0, numSamples) });
+
+    bool success;
+    float* output = arr.mutable_data();
+    {
+        py::gil_scoped_release release;
+        success = RenderEngine::renderBatch(parameterSets, renderLength, numThreads, output);
+    }
+
+    if (!success) {
+        throw std::runtime_error("Unable to render the batch. Check the render length, graph and parameter sets.");
+    }
+
+    return arr;
+}
+
+double
+RenderEngineWrapper::renderUntilSilentWrapper(double maxRenderLength, double thresholdDB, int numSilentBlocks) {
+    return (double)RenderEngine::renderUntilSilent(maxRenderLength, thresholdDB, numSilentBlocks) / mySampleRate;
+}
+
+bool
+RenderEngineWrapper::setTempoMapWrapper(std::vector<std::vector<double>> tempos) {
+
+    std::vector<TempoChange> tempoChanges;
+    for (auto& tempo : tempos) {
+        if (tempo.size() < 2 || tempo.size() > 3) {
+            throw std::invalid_argument("Each tempo must be (ppq, bpm) or (ppq, bpm, linear).");
+        }
+        tempoChanges.push_back({ tempo[0], tempo[1], tempo.size() > 2 && tempo[2] != 0. });
     }
 
-    return RenderEngine::loadGraph(*buildingDag, numInputAudioChans, numOutputAudioChans);
+    return RenderEngine::setTempoMap(tempoChanges);
+}
+
+bool
+RenderEngineWrapper::setTimeSignaturesWrapper(std::vector<std::vector<double>> timeSignatures) {
+
+    std::vector<TimeSignatureChange> timeSignatureChanges;
+    for (auto& timeSignature : timeSignatures) {
+        if (timeSignature.size() != 3) {
+            throw std::invalid_argument("Each time signature must be (ppq, numerator, denominator).");
+        }
+        timeSignatureChanges.push_back({ timeSignature[0], (int)timeSignature[1], (int)timeSignature[2] });
+    }
+
+    return RenderEngine::setTimeSignatures(timeSignatureChanges);
+}
+
+RenderIterator
+RenderEngineWrapper::renderIter(double renderLength, double chunkLength) {
+    if (!RenderEngine::startStreamingRender(renderLength, chunkLength)) {
+        throw std::runtime_error("Unable to start the render. Check the render length, chunk length and graph.");
+    }
+    return RenderIterator(*this);
+}
+
+py::array_t<float>
+RenderEngineWrapper::renderNextChunkWrapper() {
+
+    const int numSamples = RenderEngine::getNextChunkSize();
+    if (numSamples <= 0) {
+        throw py::stop_iteration();
+    }
+
+    const int numChannels = getNumOutputChannels();
+    py::array_t<float, py::array::c_style> arr({ numChannels, numSamples });
+
+    // Render straight into the numpy array's memory.
+    std::vector<float*> channels;
+    for (int chan = 0; chan < numChannels; chan++) {
+        channels.push_back(arr.mutable_data() + chan * numSamples);
+    }
+    juce::AudioSampleBuffer chunk(channels.data(), numChannels, numSamples);
+
+    RenderEngine::renderNextChunk(chunk);
+
+    return arr;
 }
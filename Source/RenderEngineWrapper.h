@@ -3,6 +3,8 @@
 #include "RenderEngine.h"
 #include "custom_pybind_wrappers.h"
 
+class RenderIterator;
+
 class RenderEngineWrapper : public RenderEngine
 {
 public:
@@ -52,4 +54,32 @@ public:
 
     bool loadGraphWrapper(py::object dagObj, int numInputAudioChans, int numOutputAudioChans);
 
+    RenderIterator renderIter(double renderLength, double chunkLength);
+
+    double renderUntilSilentWrapper(double maxRenderLength, double thresholdDB, int numSilentBlocks);
+
+    py::array_t<float> renderBatchWrapper(py::list parameterSets, double renderLength, int numThreads);
+
+    bool setTempoMapWrapper(std::vector<std::vector<double>> tempos);
+
+    bool setTimeSignaturesWrapper(std::vector<std::vector<double>> timeSignatures);
+
+    py::array_t<float> renderNextChunkWrapper();
+
+};
+
+//==========================================================================
+// Python iterator returned by RenderEngine.render_iter. Each step renders
+// and returns the next chunk of the engine's streaming render.
+class RenderIterator
+{
+public:
+
+    RenderIterator(RenderEngineWrapper& engine) : myEngine{ engine } {}
+
+    py::array_t<float> next() { return myEngine.renderNextChunkWrapper(); }
+
+private:
+
+    RenderEngineWrapper& myEngine;
 };
\ No newline at end of file
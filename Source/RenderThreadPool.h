@@ -0,0 +1,162 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small pool of persistent worker threads used by the RenderEngine to process
+// independent nodes of a graph level concurrently. The calling thread always
+// participates, so a pool of N threads owns N-1 workers. Tasks are claimed from a
+// shared atomic cursor, so an idle thread always picks up the next unclaimed node
+// instead of waiting on a fixed partition of the work.
+class RenderThreadPool
+{
+public:
+    RenderThreadPool(int numThreads) : myNumThreads{ std::max(1, numThreads) }
+    {
+        for (int i = 1; i < myNumThreads; i++) {
+            myWorkers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~RenderThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myShouldExit = true;
+        }
+        myWorkCondition.notify_all();
+        for (auto& worker : myWorkers) {
+            worker.join();
+        }
+    }
+
+    int getNumThreads() { return myNumThreads; }
+
+    // Run task(i) for every i in [0, numTasks) and return once all of them have finished. If a task throws,
+    // the tasks that haven't started are skipped and the first exception is rethrown on the calling thread.
+    void parallelFor(int numTasks, const std::function<void(int)>& task)
+    {
+        if (numTasks <= 0) {
+            return;
+        }
+
+        if (myWorkers.empty() || numTasks == 1) {
+            for (int i = 0; i < numTasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myTask = &task;
+            myNumTasks = numTasks;
+            myNextTask = 0;
+            myNumRemaining = numTasks;
+            myIsCancelled = false;
+            myException = nullptr;
+            myGeneration++;
+        }
+        myWorkCondition.notify_all();
+
+        runTasks(task, numTasks);
+
+        // Wait for the tasks to finish and for every worker to leave runTasks
+        // so that none of them can claim an index of the next generation with a stale task.
+        std::unique_lock<std::mutex> lock(myMutex);
+        myDoneCondition.wait(lock, [this]() { return myNumRemaining == 0 && myNumActiveWorkers == 0; });
+        myTask = nullptr;
+
+        if (myException) {
+            std::exception_ptr exception = myException;
+            myException = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+
+    void workerLoop()
+    {
+        uint64_t seenGeneration = 0;
+
+        while (true) {
+            const std::function<void(int)>* task;
+            int numTasks;
+            {
+                std::unique_lock<std::mutex> lock(myMutex);
+                myWorkCondition.wait(lock, [&]() { return myShouldExit || myGeneration != seenGeneration; });
+                if (myShouldExit) {
+                    return;
+                }
+                seenGeneration = myGeneration;
+                task = myTask;
+                numTasks = myNumTasks;
+                if (!task) {
+                    continue;
+                }
+                myNumActiveWorkers++;
+            }
+
+            runTasks(*task, numTasks);
+
+            {
+                std::lock_guard<std::mutex> lock(myMutex);
+                myNumActiveWorkers--;
+            }
+            myDoneCondition.notify_all();
+        }
+    }
+
+    void runTasks(const std::function<void(int)>& task, int numTasks)
+    {
+        int i;
+        while ((i = myNextTask.fetch_add(1)) < numTasks) {
+            // An exception must not leave a worker thread, which would terminate the process.
+            if (!myIsCancelled) {
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(myMutex);
+                    if (!myException) {
+                        myException = std::current_exception();
+                    }
+                    myIsCancelled = true;
+                }
+            }
+            if (myNumRemaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(myMutex);
+                myDoneCondition.notify_all();
+            }
+        }
+    }
+
+    int myNumThreads;
+    std::vector<std::thread> myWorkers;
+
+    std::mutex myMutex;
+    std::condition_variable myWorkCondition;
+    std::condition_variable myDoneCondition;
+
+    const std::function<void(int)>* myTask = nullptr;
+    int myNumTasks = 0;
+    std::atomic<int> myNextTask{ 0 };
+    std::atomic<int> myNumRemaining{ 0 };
+    int myNumActiveWorkers = 0;
+    std::atomic<bool> myIsCancelled{ false };
+    // The first exception thrown by a task of the current parallelFor.
+    std::exception_ptr myException;
+    uint64_t myGeneration = 0;
+    bool myShouldExit = false;
+
+    JUCE_DECLARE_NON_COPYABLE(RenderThreadPool)
+};
@@ -20,6 +20,8 @@ public:
         myWetLevel = myParameters.getRawParameterValue("wet_level");
         myWidth = myParameters.getRawParameterValue("width");
 
+        bindParameters({ "room_size", "damping", "dry_level", "wet_level", "width" });
+
     }
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) {
@@ -32,7 +34,8 @@ public:
 
         automateParameters();
 
-        juce::dsp::AudioBlock<float> block(buffer);
+        // juce::dsp::Reverb is mono or stereo, so only the first two channels get reverb.
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, (size_t)std::min(2, getTotalNumOutputChannels()));
         juce::dsp::ProcessContextReplacing<float> context(block);
         myReverb.process(context);
         ProcessorBase::processBlock(buffer, midiBuffer);
@@ -43,11 +46,11 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        *myRoomSize = getAutomationVal("room_size", posInfo.timeInSamples);
-        *myDamping = getAutomationVal("damping", posInfo.timeInSamples);
-        *myDryLevel = getAutomationVal("dry_level", posInfo.timeInSamples);
-        *myWetLevel = getAutomationVal("wet_level", posInfo.timeInSamples);
-        *myWidth = getAutomationVal("width", posInfo.timeInSamples);
+        *myRoomSize = getBoundAutomationVal(RoomSize, posInfo.timeInSamples);
+        *myDamping = getBoundAutomationVal(Damping, posInfo.timeInSamples);
+        *myDryLevel = getBoundAutomationVal(DryLevel, posInfo.timeInSamples);
+        *myWetLevel = getBoundAutomationVal(WetLevel, posInfo.timeInSamples);
+        *myWidth = getBoundAutomationVal(Width, posInfo.timeInSamples);
 
         updateParameters();
     }
@@ -58,6 +61,22 @@ public:
 
     const juce::String getName() { return "ReverbProcessor"; };
 
+    bool canSkipWhenSilent() { return true; }
+
+    void clearTail() { reset(); }
+
+    // The time for the longest comb filter of juce::Reverb to decay by 100 dB, plus its all-pass filters.
+    double getTailLengthSeconds() const {
+        const double feedback = myRoomSize->load() * .28 + .7;
+        return (1640. * std::log(1e-5) / std::log(feedback) + 600.) / 44100.;
+    }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new ReverbProcessor(newUniqueName, getRoomSize(), getDamping(), getWetLevel(), getDryLevel(), getWidth());
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
     void setRoomSize(float roomSize) { setAutomationVal("room_size", roomSize); }
     float getRoomSize() { return getAutomationVal("room_size", 0); }
 
@@ -75,6 +94,9 @@ public:
 
 
 private:
+    // The order of bindParameters.
+    enum BoundParameter { RoomSize, Damping, DryLevel, WetLevel, Width };
+
     juce::dsp::Reverb myReverb;
     std::atomic<float>* myRoomSize;
     std::atomic<float>* myDamping;
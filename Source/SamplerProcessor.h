@@ -10,7 +10,8 @@ public:
     {
         createParameterLayout();
         sampler.setNonRealtime(true);
-        sampler.setSample(inputData, mySampleRate);
+        mySampleData = inputData;
+        sampler.setSample(mySampleData, mySampleRate);
     }
 
     SamplerProcessor(std::string newUniqueName, py::array_t<float, py::array::c_style | py::array::forcecast> input, double sr, int blocksize) : ProcessorBase{ newUniqueName }, mySampleRate{ sr }
@@ -70,7 +71,8 @@ public:
             delete myMidiIterator;
         }
 
-        myMidiIterator = new MidiBuffer::Iterator(myMidiBuffer); // todo: deprecated.
+        mergeMidi(myMidiBuffer, myMidiSequenceQN, myMergedMidiBuffer);
+        myMidiIterator = new MidiBuffer::Iterator(myMergedMidiBuffer); // todo: deprecated.
         myMidiEventsDoRemain = myMidiIterator->getNextEvent(myMidiMessage, myMidiMessagePosition);
         myRenderMidiBuffer.clear();
     }
@@ -104,6 +106,18 @@ public:
 
     const juce::String getName() const { return "SamplerProcessor"; }
 
+    long long int getLastEventSample() {
+        return std::max(ProcessorBase::getLastEventSample(), (long long int)myMergedMidiBuffer.getLastEventTime());
+    }
+
+    ProcessorBase* clone(std::string newUniqueName) {
+        auto processor = new SamplerProcessor(newUniqueName, mySampleData, mySampleRate, getBlockSize());
+        processor->myMidiBuffer = myMidiBuffer;
+        processor->myMidiSequenceQN = myMidiSequenceQN;
+        processor->copyAutomationFrom(*this);
+        return processor;
+    }
+
     void
     setData(py::array_t<float, py::array::c_style | py::array::forcecast> input) {
         float* input_ptr = (float*)input.data();
@@ -116,47 +130,35 @@ public:
             }
         }
 
-        sampler.setSample(data, mySampleRate);
+        mySampleData = data;
+        sampler.setSample(mySampleData, mySampleRate);
     }
 
     int
     getNumMidiEvents()
     {
-        return myMidiBuffer.getNumEvents();
+        return myMidiBuffer.getNumEvents() + myMidiSequenceQN.getNumEvents();
     };
 
     bool
-    loadMidi(const std::string& path)
+    loadMidi(const std::string& path, bool beats)
     {
-        File file = File(path);
-        FileInputStream fileStream(file);
-        MidiFile midiFile;
-        midiFile.readFrom(fileStream);
-        midiFile.convertTimestampTicksToSeconds();
-        myMidiBuffer.clear();
-
-        for (int t = 0; t < midiFile.getNumTracks(); t++) {
-            const MidiMessageSequence* track = midiFile.getTrack(t);
-            for (int i = 0; i < track->getNumEvents(); i++) {
-                MidiMessage& m = track->getEventPointer(i)->message;
-                int sampleOffset = (int)(mySampleRate * m.getTimeStamp());
-                myMidiBuffer.addEvent(m, sampleOffset);
-            }
-        }
-
-        return true;
+        clearMidi();
+        return readMidiFile(path, beats, mySampleRate, myMidiBuffer, myMidiSequenceQN);
     }
 
     void
     clearMidi() {
         myMidiBuffer.clear();
+        myMidiSequenceQN.clear();
     }
 
     bool
     addMidiNote(uint8  midiNote,
             uint8  midiVelocity,
             const double noteStart,
-            const double noteLength) {
+            const double noteLength,
+            bool beats) {
 
         if (midiNote > 255) midiNote = 255;
         if (midiNote < 0) midiNote = 0;
@@ -175,6 +177,14 @@ public:
             midiNote,
             midiVelocity);
 
+        if (beats) {
+            onMessage.setTimeStamp(noteStart);
+            offMessage.setTimeStamp(noteStart + noteLength);
+            myMidiSequenceQN.addEvent(onMessage);
+            myMidiSequenceQN.addEvent(offMessage);
+            return true;
+        }
+
         auto startTime = noteStart * mySampleRate;
         onMessage.setTimeStamp(startTime);
         offMessage.setTimeStamp(startTime + noteLength * mySampleRate);
@@ -241,6 +251,8 @@ public:
         myParameters.replaceState(blankState);
 
         int usedParameterAmount = 0;
+        std::vector<std::string> parameterNames;
+        mySamplerParameterIndices.clear();
         for (int i = 0; i < sampler.getNumParameters(); ++i)
         {
             auto parameterName = sampler.getParameterName(i);
@@ -248,12 +260,16 @@ public:
             if (parameterName != "Param")
             {
                 ++usedParameterAmount;
+                parameterNames.push_back(parameterName.toStdString());
+                mySamplerParameterIndices.push_back(i);
 
                 myParameters.createAndAddParameter(std::make_unique<AutomateParameterFloat>(parameterName, parameterName, NormalisableRange<float>(0.f, 1.f), 0.f));
                 // give it a valid single sample of automation.
                 ProcessorBase::setAutomationVal(parameterName.toStdString(), sampler.getParameter(i));
             }
         }
+
+        bindParameters(parameterNames);
     }
 
     void
@@ -262,19 +278,10 @@ public:
         AudioPlayHead::CurrentPositionInfo posInfo;
         getPlayHead()->getCurrentPosition(posInfo);
 
-        for (int i = 0; i < sampler.getNumParameters(); i++) {
-
-            auto theName = sampler.getParameterName(i);
-
-            auto theParameter = ((AutomateParameterFloat*)myParameters.getParameter(theName));
-            if (theParameter) {
-                sampler.setParameterRawNotifyingHost(i, theParameter->sample(posInfo.timeInSamples));
-            }
-            else {
-                std::cout << "Error automateParameters: " << theName << std::endl;
-            }
+        for (int i = 0; i < (int)mySamplerParameterIndices.size(); i++) {
+            sampler.setParameterRawNotifyingHost(mySamplerParameterIndices[i], getBoundAutomationVal(i, posInfo.timeInSamples));
         }
-        
+
     }
 
 
@@ -284,7 +291,16 @@ private:
 
     SamplerAudioProcessor sampler;
 
+    // The index in the sampler of each bound parameter.
+    std::vector<int> mySamplerParameterIndices;
+
+    // Kept so that the processor can be cloned.
+    std::vector<std::vector<float>> mySampleData;
+
     MidiBuffer myMidiBuffer;
+    // MIDI timed in quarter notes, and all of the MIDI timed in samples for the current render.
+    MidiMessageSequence myMidiSequenceQN;
+    MidiBuffer myMergedMidiBuffer;
     MidiBuffer myRenderMidiBuffer;
     MidiMessage myMidiMessage;
     int myMidiMessagePosition = -1;
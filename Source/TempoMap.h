@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// A tempo that starts at a position in quarter notes. If isLinear is true, the tempo
+// ramps linearly to the tempo of the next change. Otherwise it's constant until then.
+class TempoChange {
+public:
+    double ppq;
+    double bpm;
+    bool isLinear;
+};
+
+// A time signature that starts at a position in quarter notes, which should be the start of a bar.
+class TimeSignatureChange {
+public:
+    double ppq;
+    int numerator;
+    int denominator;
+};
+
+// Converts between seconds and quarter notes for tempos that change over time.
+// The time at which every tempo change starts is computed up front, so a conversion
+// is a binary search followed by a closed-form step within one segment.
+class TempoMap {
+public:
+
+    TempoMap(double bpm = 120.) {
+        myTempos.push_back({ 0., bpm, false });
+        myTempoSeconds.push_back(0.);
+        myTimeSignatures.push_back({ 0., 4, 4 });
+    }
+
+    bool setTempos(const std::vector<TempoChange>& tempos) {
+
+        if (tempos.empty() || tempos.front().ppq != 0.) {
+            std::cerr << "Error: the tempo map must start with a tempo at quarter note 0." << std::endl;
+            return false;
+        }
+
+        for (size_t i = 0; i < tempos.size(); i++) {
+            if (tempos[i].bpm <= 0.) {
+                std::cerr << "Error: every tempo must be positive." << std::endl;
+                return false;
+            }
+            if (i > 0 && tempos[i].ppq <= tempos[i - 1].ppq) {
+                std::cerr << "Error: the positions of tempo changes must be in ascending order." << std::endl;
+                return false;
+            }
+        }
+
+        myTempos = tempos;
+        myTempoSeconds.resize(myTempos.size());
+        myTempoSeconds[0] = 0.;
+        for (size_t i = 1; i < myTempos.size(); i++) {
+            myTempoSeconds[i] = myTempoSeconds[i - 1] + secondsInSegment(i - 1, myTempos[i].ppq - myTempos[i - 1].ppq);
+        }
+
+        return true;
+    }
+
+    bool setTimeSignatures(const std::vector<TimeSignatureChange>& timeSignatures) {
+
+        std::vector<TimeSignatureChange> newTimeSignatures;
+        if (timeSignatures.empty() || timeSignatures.front().ppq > 0.) {
+            newTimeSignatures.push_back({ 0., 4, 4 });
+        }
+
+        for (auto& timeSignature : timeSignatures) {
+            if (timeSignature.numerator <= 0 || timeSignature.denominator <= 0) {
+                std::cerr << "Error: the numerator and denominator of a time signature must be positive." << std::endl;
+                return false;
+            }
+            if (!newTimeSignatures.empty() && timeSignature.ppq <= newTimeSignatures.back().ppq) {
+                std::cerr << "Error: the positions of time signatures must be in ascending order." << std::endl;
+                return false;
+            }
+            newTimeSignatures.push_back(timeSignature);
+        }
+
+        myTimeSignatures = newTimeSignatures;
+
+        return true;
+    }
+
+    const std::vector<TempoChange>& getTempos() const { return myTempos; }
+
+    double ppqToSeconds(double ppq) const {
+        ppq = std::max(0., ppq);
+        auto next = std::upper_bound(myTempos.begin(), myTempos.end(), ppq,
+            [](double p, const TempoChange& tempo) { return p < tempo.ppq; });
+        size_t i = (size_t)(next - myTempos.begin()) - 1;
+        return myTempoSeconds[i] + secondsInSegment(i, ppq - myTempos[i].ppq);
+    }
+
+    double secondsToPPQ(double seconds) const {
+        seconds = std::max(0., seconds);
+        size_t i = (size_t)(std::upper_bound(myTempoSeconds.begin(), myTempoSeconds.end(), seconds) - myTempoSeconds.begin()) - 1;
+        return myTempos[i].ppq + ppqInSegment(i, seconds - myTempoSeconds[i]);
+    }
+
+    double getBPM(double ppq) const {
+        ppq = std::max(0., ppq);
+        auto next = std::upper_bound(myTempos.begin(), myTempos.end(), ppq,
+            [](double p, const TempoChange& tempo) { return p < tempo.ppq; });
+        size_t i = (size_t)(next - myTempos.begin()) - 1;
+        return myTempos[i].bpm + getSlope(i) * (ppq - myTempos[i].ppq);
+    }
+
+    // The time signature at ppq and the position of the bar that contains ppq.
+    const TimeSignatureChange& getTimeSignature(double ppq, double& barStartPPQ) const {
+        auto next = std::upper_bound(myTimeSignatures.begin(), myTimeSignatures.end(), ppq,
+            [](double p, const TimeSignatureChange& timeSignature) { return p < timeSignature.ppq; });
+        auto& timeSignature = next == myTimeSignatures.begin() ? myTimeSignatures.front() : *(next - 1);
+
+        const double barLength = timeSignature.numerator * 4. / timeSignature.denominator;
+        barStartPPQ = timeSignature.ppq + std::floor((ppq - timeSignature.ppq) / barLength) * barLength;
+
+        return timeSignature;
+    }
+
+private:
+
+    std::vector<TempoChange> myTempos;
+    // The time in seconds at which each tempo change starts.
+    std::vector<double> myTempoSeconds;
+    std::vector<TimeSignatureChange> myTimeSignatures;
+
+    // The change in BPM per quarter note during segment i.
+    double getSlope(size_t i) const {
+        if (!myTempos[i].isLinear || i + 1 >= myTempos.size()) {
+            return 0.;
+        }
+        return (myTempos[i + 1].bpm - myTempos[i].bpm) / (myTempos[i + 1].ppq - myTempos[i].ppq);
+    }
+
+    // The seconds it takes to advance ppq quarter notes from the start of segment i.
+    double secondsInSegment(size_t i, double ppq) const {
+        const double bpm = myTempos[i].bpm;
+        const double slope = getSlope(i);
+        if (slope == 0.) {
+            return ppq * 60. / bpm;
+        }
+        return 60. / slope * std::log((bpm + slope * ppq) / bpm);
+    }
+
+    // The quarter notes that pass in the given seconds from the start of segment i.
+    double ppqInSegment(size_t i, double seconds) const {
+        const double bpm = myTempos[i].bpm;
+        const double slope = getSlope(i);
+        if (slope == 0.) {
+            return seconds * bpm / 60.;
+        }
+        return bpm * std::expm1(slope * seconds / 60.) / slope;
+    }
+};
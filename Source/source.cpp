@@ -29,15 +29,28 @@ PYBIND11_MODULE(dawdreamer, m)
     )pbdoc";
 
     py::class_<ProcessorBase, std::shared_ptr<ProcessorBase>>(m, "ProcessorBase")
-        .def("set_automation", &ProcessorBase::setAutomation, arg("parameter_name"), arg("data"), R"pbdoc(
+        .def_static("get_num_instances", &ProcessorBase::getNumInstances,
+            "The number of processors alive in this process, including those that only a RenderEngine refers to.")
+        .def("set_automation", &ProcessorBase::setAutomation, arg("parameter_name"), arg("data"), arg("mode") = "samples", arg("rate") = 0.,
+            arg("ppq") = false, R"pbdoc(
     Set a parameter's automation with a numpy array.
 
     Parameters
     ----------
     parameter_name : str
         The name of the parameter.
-    data : str
-        An array of data for the parameter automation.
+    data : np.array
+        An array of data for the parameter automation, as described by `mode`.
+    mode : str
+        "samples" for one value per audio sample. "control" for values at `rate` per second that are interpolated
+        linearly, which takes far less memory for long renders. "breakpoints" for an envelope given as rows of
+        (time, value) or (time, value, curve) with ascending times in seconds. A curve of 0 makes the segment that
+        starts at the breakpoint linear, and positive or negative curves bend it exponentially.
+    rate : float
+        The number of values per second in "control" mode.
+    ppq : bool
+        Measure "control" and "breakpoints" automation in quarter notes instead of seconds,
+        so `rate` is the number of values per quarter note and breakpoint times are in quarter notes.
 
     Returns
     -------
@@ -57,14 +70,60 @@ PYBIND11_MODULE(dawdreamer, m)
     Returns
     -------
     np.array
-        The parameter's automation.
+        The parameter's automation with one value per sample. Control-rate and breakpoint automation
+        is evaluated up to its last point, using the sample rate and tempo of the most recent render.
 
     """
     ----------
 
 )pbdoc")
         .def_property("record", &ProcessorBase::getRecordEnable, &ProcessorBase::setRecordEnable, "Whether recording of this processor is enabled." )
-        .def("get_audio", &ProcessorBase::getAudioFrames, "Get the audio data of the processor after a render, assuming recording was enabled.")
+        .def("get_audio", &ProcessorBase::getAudioFrames, "Get the audio data of the processor after a render, assuming recording was enabled. \
+The array is a read-only view of the recording without a copy, and it stays valid after later renders. \
+To change the audio in place, call .copy() on the array first.")
+        .def("set_recording_options", &ProcessorBase::setRecordingOptions, arg("channels") = std::vector<int>(), arg("dtype") = "float32",
+            arg("decimation") = 1, arg("start") = 0., arg("end") = 0., R"pbdoc(
+    Choose what the processor records in memory when `record` is enabled, so that recording many processors takes
+    less memory. The options apply from the next render.
+
+    Parameters
+    ----------
+    channels : list[int]
+        The output channels to record, in order. Channels that the processor doesn't have are recorded as silence.
+        The default (an empty list) records every output channel.
+    dtype : str
+        "float32" (default), "int16" or "float16". The array from `get_audio` has this data type.
+    decimation : int
+        Keep every Nth sample, starting at `start`. The default of 1 keeps every sample.
+    start : float
+        The time in seconds at which recording starts.
+    end : float
+        The time in seconds at which recording ends. The default of 0 records until the end of the render.
+
+    Returns
+    -------
+    bool
+        Whether the options were valid.
+
+)pbdoc")
+        .def("record_to_file", &ProcessorBase::setRecordToFile, arg("filepath"), arg("bit_depth") = 24, R"pbdoc(
+    Write this processor's output to an audio file during every render. Blocks are written to disk by a background
+    thread while rendering, independently of the `record` property.
+
+    Parameters
+    ----------
+    filepath : str
+        The path of the file. The extension (".wav", ".flac" or ".aiff") chooses the format. An empty string disables it.
+    bit_depth : int
+        The bit depth of the file. FLAC supports up to 24. WAV also supports 32 (floating point).
+
+    Returns
+    -------
+    None
+
+    """
+    ----------
+)pbdoc")
         .def("get_name", &ProcessorBase::getUniqueName, "Get the user-defined name of a processor instance.").doc() = R"pbdoc(
     The abstract Processor Base class, which all processors subclass.
 )pbdoc";
@@ -72,7 +131,7 @@ PYBIND11_MODULE(dawdreamer, m)
     py::class_<OscillatorProcessor, std::shared_ptr<OscillatorProcessor>, ProcessorBase>(m, "OscillatorProcessor");
 
     py::class_<PlaybackProcessor, std::shared_ptr<PlaybackProcessor>, ProcessorBase>(m, "PlaybackProcessor")
-        .def("set_data", &PlaybackProcessor::setData, arg("data"), "Set the audio as a 2xN numpy array.")
+        .def("set_data", &PlaybackProcessor::setData, arg("data"), "Set the audio as a numpy array of shape (channels, samples).")
         .doc() = "The Playback Processor can play audio data provided as an argument.";
 
 #ifdef BUILD_DAWDREAMER_RUBBERBAND
@@ -89,7 +148,7 @@ play the audio in double the amount of time, so it will sound slowed down.")
         .def_property("end_marker", &PlaybackWarpProcessor::getEndMarker, &PlaybackWarpProcessor::setEndMarker, "The end position in beats (typically quarter notes) relative to 1.1.1")
         .def("set_clip_file", &PlaybackWarpProcessor::loadAbletonClipInfo, arg("asd_file_path"), "Load an Ableton Live file with an \".asd\" extension")
         .def_property_readonly("warp_markers", &PlaybackWarpProcessor::getWarpMarkers, "Get the warp markers as a 2D array of time positions in seconds and positions in beats.")
-        .def("set_data", &PlaybackWarpProcessor::setData, arg("data"), "Set the audio as a 2xN numpy array")
+        .def("set_data", &PlaybackWarpProcessor::setData, arg("data"), "Set the audio as a numpy array of shape (channels, samples).")
         .def("set_clip_positions", &PlaybackWarpProcessor::setClipPositions, arg("clip_positions"), R"pbdoc(
     Set one or more positions at which the clip should play.
 
@@ -136,6 +195,9 @@ play the audio in double the amount of time, so it will sound slowed down.")
             "The Q-value. A safe choice is 1./rad(2)=0.707107." )
         .def_property("gain", &FilterProcessor::getGain, &FilterProcessor::setGain,
             "The gain parameter only matters when the mode is low_shelf or high_shelf. A value of 1.0 has no effect.")
+        .def_property("smoothing", &FilterProcessor::getSmoothing, &FilterProcessor::setSmoothing,
+            "If True, the filter coefficients glide to their new values over each block instead of jumping at the start of it, \
+which avoids clicks when the frequency, Q or gain are automated. The default is False.")
         .doc() = "A Filter Processor applies one of several kinds of filters. The filter cutoff, Q-value and gain can be adjusted, \
 but the filter mode cannot under automation.";
 
@@ -149,8 +211,11 @@ but the filter mode cannot under automation.";
 
     py::class_<AddProcessor, std::shared_ptr<AddProcessor>, ProcessorBase>(m, "AddProcessor")
         .def_property("gain_levels", &AddProcessor::getGainLevels, &AddProcessor::setGainLevels,
-            "A list of gain levels to apply to the corresponding inputs.")
-        .doc() = "An Add Processor adds one or more stereo inputs with corresponding gain parameters.";
+            "A list of gain levels to apply to the corresponding inputs. The gain of input i is also the parameter \"gain_i\", which can be automated. \
+The list can't be longer than the one the processor was made with.")
+        .doc() = "An Add Processor adds one or more inputs with corresponding gain parameters. A mono input is added to every \
+output channel. An input with fewer channels than the output is added to its first channels, and an input with more \
+channels than the output only has its first channels added.";
 
     py::class_<PluginProcessorWrapper, std::shared_ptr<PluginProcessorWrapper>, ProcessorBase>(m, "PluginProcessor")
         .def("load_preset", &PluginProcessorWrapper::loadPreset, arg("filepath"), "Load an FXP preset.")
@@ -163,17 +228,20 @@ but the filter mode cannot under automation.";
         .def("set_parameter", &PluginProcessorWrapper::wrapperSetParameter, arg("index"), arg("value"),
             "Set a parameter's value to a constant.")
         .def("set_automation", &PluginProcessorWrapper::wrapperSetAutomation, arg("parameter_index"), arg("data"),
-            "Set the automation based on its index.")
+            arg("mode") = "samples", arg("rate") = 0., arg("ppq") = false,
+            "Set the automation based on its index. The other arguments are as in `ProcessorBase.set_automation`.")
         .def("get_plugin_parameter_size", &PluginProcessorWrapper::wrapperGetPluginParameterSize, "Get the number of parameters.")
         .def("get_plugin_parameters_description", &PluginProcessorWrapper::getPluginParametersDescription,
             "Get a list of dictionaries describing the plugin's parameters.")
         .def_property_readonly("n_midi_events", &PluginProcessorWrapper::getNumMidiEvents, "The number of MIDI events stored in the buffer. \
 Note that note-ons and note-offs are counted separately.")
-        .def("load_midi", &PluginProcessorWrapper::loadMidi, arg("filepath"), "Load MIDI from a file.")
+        .def("load_midi", &PluginProcessorWrapper::loadMidi, arg("filepath"), arg("beats") = false,
+            "Load MIDI from a file. If `beats` is true, its times are kept in quarter notes and follow the engine's tempo map.")
         .def("clear_midi", &PluginProcessorWrapper::clearMidi, "Remove all MIDI notes.")
         .def("add_midi_note", &PluginProcessorWrapper::addMidiNote,
-            arg("note"), arg("velocity"), arg("start_time"), arg("duration"),
-            "Add a single MIDI note whose note and velocity are integers between 0 and 127.")
+            arg("note"), arg("velocity"), arg("start_time"), arg("duration"), arg("beats") = false,
+            "Add a single MIDI note whose note and velocity are integers between 0 and 127. \
+The start time and duration are in seconds, or in quarter notes of the engine's tempo map if `beats` is true.")
         .doc() = "A Plugin Processor can load VST \".dll\" files on Windows and \".vst\" files on macOS. The files can be for either instruments \
 or effects. Some plugins such as ones that do sidechain compression can accept two inputs when loading a graph.";
 
@@ -189,22 +257,61 @@ or effects. Some plugins such as ones that do sidechain compression can accept t
             "Get a list of dictionaries describing the plugin's parameters.")
         .def_property_readonly("n_midi_events", &SamplerProcessor::getNumMidiEvents, "The number of MIDI events stored in the buffer. \
 Note that note-ons and note-offs are counted separately.")
-        .def("load_midi", &SamplerProcessor::loadMidi, arg("filepath"), "Load MIDI from a file.")
+        .def("load_midi", &SamplerProcessor::loadMidi, arg("filepath"), arg("beats") = false,
+            "Load MIDI from a file. If `beats` is true, its times are kept in quarter notes and follow the engine's tempo map.")
         .def("clear_midi", &SamplerProcessor::clearMidi, "Remove all MIDI notes.")
         .def("add_midi_note", &SamplerProcessor::addMidiNote,
-            arg("note"), arg("velocity"), arg("start_time"), arg("duration"),
-            "Add a single MIDI note whose note and velocity are integers between 0 and 127.")
+            arg("note"), arg("velocity"), arg("start_time"), arg("duration"), arg("beats") = false,
+            "Add a single MIDI note whose note and velocity are integers between 0 and 127. \
+The start time and duration are in seconds, or in quarter notes of the engine's tempo map if `beats` is true.")
         .doc() = "The Sampler Processor works like a basic Sampler instrument. It takes a typically short audio sample and can play it back \
 at different pitches and speeds. It has parameters for an ADSR envelope controlling the amplitude and another for controlling a low-pass filter cutoff. \
 Unlike a VST, the parameters don't need to be between 0 and 1. For example, you can set an envelope attack parameter to 50 to represent 50 milliseconds.";
 
 #ifdef BUILD_DAWDREAMER_FAUST
+    py::class_<std::shared_future<bool>>(m, "FaustCompileFuture")
+        .def("result", [](std::shared_future<bool>& future) { py::gil_scoped_release release; return future.get(); },
+            "Wait for the compile to finish and return whether it succeeded.")
+        .def("done", [](std::shared_future<bool>& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; },
+            "Whether the compile has finished.")
+        .doc() = "The result of FaustProcessor.compile_async.";
+
     py::class_<FaustProcessor, std::shared_ptr<FaustProcessor>, ProcessorBase>(m, "FaustProcessor")
         .def("set_dsp", &FaustProcessor::setDSPFile, arg("filepath"), "Set the FAUST signal process with a file.")
         .def("set_dsp_string", &FaustProcessor::setDSPString, arg("faust_code"), 
             "Set the FAUST signal process with a string containing FAUST code.")
         .def("compile", &FaustProcessor::compile, "Compile the FAUST object. You must have already set a dsp file path or dsp string.")
+        .def("compile_async", &FaustProcessor::compileAsync, "Compile the FAUST object on another thread and return a FaustCompileFuture. \
+Don't change or render the processor until its result() is ready. `load_graph` also compiles every uncompiled FaustProcessor of the graph \
+at the same time.")
+        .def("clone", [](FaustProcessor& processor, std::string newName) { return std::shared_ptr<FaustProcessor>((FaustProcessor*)processor.clone(newName)); },
+            arg("new_name"), "Make a copy of the processor with a new name. It has the same code, settings, MIDI and automation. \
+If the processor is compiled, the copy shares its compiled code instead of compiling it again. Returns None if the code doesn't compile.")
         .def_property("auto_import", &FaustProcessor::getAutoImport, &FaustProcessor::setAutoImport, "The auto import string. Default is `import(\"stdfaust.lib\");`")
+        .def_property("compile_flags", &FaustProcessor::getCompileFlags, &FaustProcessor::setCompileFlags, "A list of flags for the Faust compiler, \
+such as `[\"-vec\", \"-vs\", \"32\"]` for vectorized code or `[\"-fun\"]`. The path to the Faust libraries is added to them. The default is no flags.")
+        .def_property("target", &FaustProcessor::getTarget, &FaustProcessor::setTarget, "The LLVM target of the compiled code as \"triple:cpu\", \
+for example \"x86_64-pc-linux-gnu:skylake-avx512\". The default of an empty string compiles for this machine.")
+        .def("benchmark_compile_flags", &FaustProcessor::benchmarkCompileFlags, arg("flag_sets"), arg("duration") = 1., arg("block_size") = 512, R"pbdoc(
+    Compile the DSP with each of several sets of compiler flags and time how long it takes to render.
+
+    Parameters
+    ----------
+    flag_sets : list[list[str]]
+        The sets of flags, such as `[[], ["-vec", "-vs", "32"], ["-vec", "-lv", "1", "-dfs"]]`.
+
+    duration : float
+        The seconds of audio to render with each set of flags.
+
+    block_size : int
+        The number of samples rendered at a time.
+
+    Returns
+    -------
+    list[float]
+        The time in seconds that each set of flags took, which is infinite if it didn't compile. Polyphonic DSPs are
+        timed as one voice. Set `compile_flags` to the fastest set to use it.
+)pbdoc")
         .def("get_parameters_description", &FaustProcessor::getPluginParametersDescription,
             "Get a list of dictionaries describing the parameters of the most recently compiled FAUST code.")
         .def("get_parameter", &FaustProcessor::getParamWithIndex, arg("param_index"))
@@ -217,11 +324,19 @@ Unlike a VST, the parameters don't need to be between 0 and 1. For example, you
         .def_property("group_voices", &FaustProcessor::getGroupVoices, &FaustProcessor::setGroupVoices, "If grouped, all polyphonic voices will share the same parameters. This parameter only matters if polyphony is enabled.")
         .def_property_readonly("n_midi_events", &FaustProcessor::getNumMidiEvents, "The number of MIDI events stored in the buffer. \
 Note that note-ons and note-offs are counted separately.")
-        .def("load_midi", &FaustProcessor::loadMidi, arg("filepath"), "Load MIDI from a file.")
+        .def("load_midi", &FaustProcessor::loadMidi, arg("filepath"), arg("beats") = false,
+            "Load MIDI from a file. If `beats` is true, its times are kept in quarter notes and follow the engine's tempo map.")
         .def("clear_midi", &FaustProcessor::clearMidi, "Remove all MIDI notes.")
-        .def("add_midi_note", &FaustProcessor::addMidiNote, arg("note"), arg("velocity"), arg("start_time"), arg("duration"),
-    "Add a single MIDI note whose note and velocity are integers between 0 and 127.")
+        .def("add_midi_note", &FaustProcessor::addMidiNote, arg("note"), arg("velocity"), arg("start_time"), arg("duration"), arg("beats") = false,
+    "Add a single MIDI note whose note and velocity are integers between 0 and 127. \
+The start time and duration are in seconds, or in quarter notes of the engine's tempo map if `beats` is true.")
         .def("set_soundfiles", &FaustProcessor::setSoundfiles, arg("soundfile_dict"), "Set the audio data that the FaustProcessor can use with the `soundfile` primitive.")
+        .def_static("set_cache_dir", &FaustFactoryCache::setCacheDirectory, arg("path"), "Save compiled DSPs in a directory as machine code, \
+so that compiling the same code with the same options in any process loads it instead. The files are keyed by the code with its imported \
+libraries expanded, so editing a library compiles again. An empty path disables it. Compiled DSPs are also kept in memory for the rest of \
+the process, keyed by the code without its libraries, so call clear_cache after editing a library in a running process.")
+        .def_static("get_cache_dir", &FaustFactoryCache::getCacheDirectory, "The directory of compiled DSPs, or an empty string if there isn't one.")
+        .def_static("clear_cache", &FaustFactoryCache::clear, "Forget the compiled DSPs kept in memory. The cache directory is left as it is.")
         .doc() = "A Faust Processor can compile and execute FAUST code. See https://faust.grame.fr for more information.";
 #endif
 
@@ -229,14 +344,152 @@ Note that note-ons and note-offs are counted separately.")
 
     py::return_value_policy returnPolicy = py::return_value_policy::take_ownership;
 
+    py::class_<RenderIterator>(m, "RenderIterator", "An iterator over the chunks of a streaming render.")
+        .def("__iter__", [](RenderIterator& it) -> RenderIterator& { return it; })
+        .def("__next__", &RenderIterator::next);
+
     py::class_<RenderEngineWrapper>(m, "RenderEngine", "A Render Engine loads and runs a graph of audio processors.")
         .def(py::init<double, int>(), arg("sample_rate"), arg("block_size"))
         .def("render", &RenderEngineWrapper::render, arg("seconds"), "Render the most recently loaded graph.")
-        .def("set_bpm", &RenderEngineWrapper::setBPM, arg("bpm"), "Set the beats-per-minute of the engine.")
-        .def("get_audio", &RenderEngine::getAudioFrames, "Get the most recently rendered audio as a numpy array.")
-        .def("get_audio", &RenderEngine::getAudioFramesForName, arg("name"), "Get the most recently rendered audio for a specific processor.")
+        .def("render_iter", &RenderEngineWrapper::renderIter, arg("seconds"), arg("chunk_seconds"), py::keep_alive<0, 1>(), R"pbdoc(
+    Render the most recently loaded graph one chunk at a time.
+
+    Parameters
+    ----------
+    seconds : float
+        The total length of the render.
+    chunk_seconds : float
+        The length of each chunk. The last chunk may be shorter.
+
+    Returns
+    -------
+    RenderIterator
+        An iterator yielding the output of the graph as numpy arrays of shape (channels, samples).
+        Processors don't record during this kind of render, and calling `render` or `load_graph` ends it.
+)pbdoc")
+        .def("render_until_silent", &RenderEngineWrapper::renderUntilSilentWrapper, arg("max_seconds"), arg("threshold_db") = -80.,
+            arg("silent_blocks") = 16, R"pbdoc(
+    Render the most recently loaded graph until its output falls silent, so that tails of reverbs and delays
+    are captured without padding every render to a worst-case length. Silence is only checked after the last
+    MIDI event, the last automation change, the end of playback audio and the longest tail reported by a processor
+    or plugin. Infinite tails are ignored, so the threshold decides when they end.
+
+    Parameters
+    ----------
+    max_seconds : float
+        The longest the render can be. It must be at most 2^31 - 1 samples long.
+    threshold_db : float
+        Blocks whose peak is below this level in decibels are silent.
+    silent_blocks : int
+        The number of consecutive silent blocks that end the render.
+
+    Returns
+    -------
+    float
+        The rendered length in seconds. `get_audio` returns recordings of this length.
+)pbdoc")
+        .def("render_batch", &RenderEngineWrapper::renderBatchWrapper, arg("parameter_sets"), arg("seconds"), arg("num_threads") = 0, R"pbdoc(
+    Render the most recently loaded graph once per parameter set. The graph is cloned for every thread and the
+    clones render the variants concurrently, so the graph's own processors and automation are left unchanged.
+
+    Parameters
+    ----------
+    parameter_sets : list[dict]
+        One dictionary per render, mapping processor names to dictionaries of parameter names and values.
+        A value can be a float or a numpy array of automation, as in `set_automation`.
+        Parameters that aren't mentioned keep the graph's automation.
+    seconds : float
+        The length of each render.
+    num_threads : int
+        The number of threads to render on. Set to 0 to use every CPU.
+
+    Returns
+    -------
+    ndarray
+        The output of the graph for every parameter set, with shape (batch, channels, samples).
+)pbdoc")
+        .def("set_bpm", &RenderEngineWrapper::setBPM, arg("bpm"), "Set the beats-per-minute of the engine. This replaces the tempo map with a constant tempo.")
+        .def("set_tempo_map", &RenderEngineWrapper::setTempoMapWrapper, arg("tempos"), R"pbdoc(
+    Set tempo changes that the play head, PPQ automation and MIDI in beats follow.
+
+    Parameters
+    ----------
+    tempos : list
+        A list of (ppq, bpm) or (ppq, bpm, linear) in ascending order, where ppq is the position of the change
+        in quarter notes. The first tempo must be at position 0. If linear is true, the tempo ramps linearly
+        to the next tempo instead of staying constant until it.
+
+    Returns
+    -------
+    bool
+        Whether the tempo map was valid.
+)pbdoc")
+        .def("set_time_signatures", &RenderEngineWrapper::setTimeSignaturesWrapper, arg("time_signatures"), R"pbdoc(
+    Set the time signatures reported by the play head.
+
+    Parameters
+    ----------
+    time_signatures : list
+        A list of (ppq, numerator, denominator) in ascending order, where ppq is the position in quarter notes
+        of the bar where the time signature starts. The time signature is 4/4 before the first one.
+
+    Returns
+    -------
+    bool
+        Whether the time signatures were valid.
+)pbdoc")
+        .def_property("num_threads", &RenderEngineWrapper::getNumThreads, &RenderEngineWrapper::setNumThreads,
+            "The number of threads used to process independent branches of the graph. The default is 1. \
+Set to 0 to use every CPU. Plugins and processors must be safe to run concurrently with each other.")
+        .def_property("automation_interval", &RenderEngineWrapper::getAutomationInterval, &RenderEngineWrapper::setAutomationInterval,
+            "The minimum number of samples between automation updates. When it's greater than 0, blocks are split wherever automation \
+changes, so a large block size renders automation as accurately as a block size of 1. Set to 1 for sample-accurate automation. \
+The default is 0, which reads automation once per block.")
+        .def_property("skip_silent_nodes", &RenderEngineWrapper::getSkipSilence, &RenderEngineWrapper::setSkipSilence,
+            "Whether to skip processors whose inputs have been silent for longer than their tail and which have no pending \
+MIDI or audio, writing silence instead. Output below -120 dB counts as silent. Only the built-in effects, playback and \
+recorders are ever skipped. A skipped reverb or filter would otherwise have output a tail below -100 dB, and it starts from \
+silence when its input resumes, so renders differ very slightly. The default is False.")
+        .def("get_audio", &RenderEngine::getAudioFrames, "Get the most recently rendered audio as a read-only numpy array. To change it in place, call .copy() on it first.")
+        .def("get_audio", &RenderEngine::getAudioFramesForName, arg("name"), "Get the most recently rendered audio for a specific processor as a read-only numpy array. \
+To change it in place, call .copy() on it first.")
+        .def_property("profile", &RenderEngineWrapper::getProfiling, &RenderEngineWrapper::setProfiling,
+            "Whether renders time every processor for `get_profile`. Timing takes a little time per block and a few \
+kilobytes per processor, however long the render is. The default is False.")
+        .def("get_profile", &RenderEngine::getProfile, R"pbdoc(
+    Get the time spent by every processor during the most recent render. It's empty unless `profile` was True
+    for that render.
+
+    Returns
+    -------
+    dict
+        A dictionary of processor names to dictionaries with the keys "total_ns", "mean_ns", "max_ns", "p99_ns"
+        and "blocks". Times are in nanoseconds per block. The "_render" entry times whole blocks of the graph,
+        so its "total_ns" is the wall time of the render. "p99_ns" is read from a histogram, so it can be up to
+        12.5% higher than the exact percentile.
+)pbdoc")
         .def("load_graph", &RenderEngineWrapper::loadGraphWrapper, arg("dag"), arg("num_input_audio_chans") = 2, arg("num_out_audio_chans") = 2,
-            "Load a directed acyclic graph of processors.")
+            R"pbdoc(
+    Load a directed acyclic graph of processors.
+
+    Parameters
+    ----------
+    dag : list
+        A list of (processor, inputs) or (processor, inputs, num_channels) tuples, where inputs is a list of the names
+        of earlier processors. The channels of the inputs are laid out one after another. num_channels is the number
+        of channels the processor outputs. By default it's num_out_audio_chans. The output of the engine has the
+        channels of the last processor.
+    num_input_audio_chans : int
+        Unused.
+    num_out_audio_chans : int
+        The default number of output channels of every processor.
+
+    Returns
+    -------
+    bool
+        Whether the graph was loaded.
+
+)pbdoc")
         .def("make_oscillator_processor", &RenderEngineWrapper::makeOscillatorProcessor, arg("name"), arg("frequency"),
             "Make an Oscillator Processor", returnPolicy)
         .def("make_plugin_processor", &RenderEngineWrapper::makePluginProcessor, arg("name"), arg("plugin_path"),
@@ -0,0 +1,26 @@
+# Builds the C++ benchmark against the objects of the Projucer Makefile. Run it from Builds/LinuxMakefile:
+#
+#   make CONFIG=Release
+#   make -f ../../benchmarks/Benchmark.mk CONFIG=Release
+#   ./build/dawdreamer_benchmark --json results.json
+
+include Makefile
+
+.DEFAULT_GOAL := benchmark
+
+BENCHMARK_TARGET := dawdreamer_benchmark
+BENCHMARK_OBJECTS := $(JUCE_OBJDIR)/benchmark.o
+
+.PHONY: benchmark
+
+benchmark : $(JUCE_OUTDIR)/$(BENCHMARK_TARGET)
+
+$(JUCE_OUTDIR)/$(BENCHMARK_TARGET) : $(OBJECTS_DYNAMIC_LIBRARY) $(BENCHMARK_OBJECTS)
+	@echo Linking "DawDreamer - Benchmark"
+	-$(V_AT)mkdir -p $(JUCE_OUTDIR)
+	$(V_AT)$(CXX) -o $@ $(BENCHMARK_OBJECTS) $(OBJECTS_DYNAMIC_LIBRARY) $(JUCE_LDFLAGS) $(shell python3-config --ldflags --embed) $(TARGET_ARCH)
+
+$(JUCE_OBJDIR)/benchmark.o: ../../benchmarks/benchmark.cpp
+	-$(V_AT)mkdir -p $(JUCE_OBJDIR)
+	@echo "Compiling benchmark.cpp"
+	$(V_AT)$(CXX) $(JUCE_CXXFLAGS) $(JUCE_CPPFLAGS_DYNAMIC_LIBRARY) $(JUCE_CFLAGS_DYNAMIC_LIBRARY) -o "$@" -c "$<"
@@ -0,0 +1,392 @@
+// Benchmarks for DawDreamer's processors and for common graph topologies.
+//
+// Every benchmark renders a graph through the RenderEngine. Processor benchmarks feed
+// the processor with noise and report the time spent in its processBlock, measured by the
+// engine's profiler. Topology benchmarks report the wall time of the whole render.
+// The results are written as JSON so that they can be compared between releases.
+//
+// Usage: dawdreamer_benchmark [--json path] [--seconds 2] [--repetitions 3] [--filter name]
+
+#include "../Source/RenderEngine.h"
+
+#include <functional>
+#include <iostream>
+
+namespace {
+
+const double SAMPLE_RATE = 44100.;
+
+class BenchmarkOptions {
+public:
+    std::string jsonPath;
+    double seconds = 2.;
+    int repetitions = 3;
+    std::string filter;
+};
+
+class BenchmarkResult {
+public:
+    std::string name;
+    int blockSize = 0;
+    int numThreads = 1;
+    juce::int64 numSamples = 0;
+    double wallNs = 0.;
+    // Only set for processor benchmarks.
+    bool hasProcessorStats = false;
+    ProfileStats processorStats;
+};
+
+// Makes the graph to render and returns the name of the processor being measured, if any.
+typedef std::function<std::string(DAG& dag, double sampleRate, int blockSize)> GraphFactory;
+
+std::vector<std::vector<float>>
+makeNoise(double seconds, int numChannels = 2) {
+    juce::Random random(1234);
+    std::vector<std::vector<float>> noise(numChannels, std::vector<float>((size_t)(seconds * SAMPLE_RATE) + 1));
+    for (auto& channel : noise) {
+        for (auto& sample : channel) {
+            sample = random.nextFloat() * 2.f - 1.f;
+        }
+    }
+    return noise;
+}
+
+DAGNode
+makeDagNode(std::shared_ptr<ProcessorBase> processor, std::vector<std::string> inputs = {}) {
+    DAGNode node;
+    node.processorBase = processor;
+    node.inputs = inputs;
+    return node;
+}
+
+// One note every quarter second over a few octaves, for the instruments.
+template <typename Instrument>
+void
+addNotes(Instrument& instrument, double seconds) {
+    int note = 48;
+    for (double time = 0.; time < seconds; time += .25) {
+        instrument.addMidiNote((uint8)note, 100, time, .2, false);
+        note = note >= 72 ? 48 : note + 5;
+    }
+}
+
+// An effect processing noise.
+GraphFactory
+effect(std::function<ProcessorBase*(const std::string& name)> makeEffect, double seconds) {
+    return [makeEffect, seconds](DAG& dag, double, int) {
+        dag.nodes.push_back(makeDagNode(std::make_shared<PlaybackProcessor>("noise", makeNoise(seconds + 1.))));
+        std::shared_ptr<ProcessorBase> processor(makeEffect("effect"));
+        dag.nodes.push_back(makeDagNode(processor, { "noise" }));
+        return processor->getUniqueName();
+    };
+}
+
+#ifdef BUILD_DAWDREAMER_FAUST
+const std::string FAUST_EFFECT = R"faust(
+process = _,_ : (+ ~ *(0.9)), (+ ~ *(0.9)) : *(0.1), *(0.1);
+)faust";
+
+const std::string FAUST_INSTRUMENT = R"faust(
+freq = hslider("freq", 200, 50, 1000, 0.01);
+gain = hslider("gain", 0.5, 0, 1, 0.01);
+gate = button("gate");
+SR = fconstant(int fSamplingFreq, <math.h>);
+frac(x) = x - floor(x);
+phasor = (+(freq/SR) : frac) ~ _;
+process = sin(phasor*6.283185307) * gain * gate <: _,_;
+)faust";
+
+std::shared_ptr<FaustProcessor>
+makeFaustProcessor(const std::string& name, const std::string& code, int numVoices, double sampleRate, int blockSize) {
+    auto processor = std::make_shared<FaustProcessor>(name, sampleRate, blockSize);
+    // The benchmark's code doesn't need the Faust libraries.
+    processor->setAutoImport("");
+    processor->setDSPString(code);
+    processor->setNumVoices(numVoices);
+    processor->compile();
+    return processor;
+}
+#endif
+
+std::vector<std::pair<std::string, GraphFactory>>
+makeProcessorBenchmarks(double seconds) {
+
+    std::vector<std::pair<std::string, GraphFactory>> benchmarks;
+
+    benchmarks.push_back({ "FilterProcessor", effect([](const std::string& name) {
+        return new FilterProcessor(name, "low", 1000.f, .707f, 1.f);
+    }, seconds) });
+
+    benchmarks.push_back({ "CompressorProcessor", effect([](const std::string& name) {
+        return new CompressorProcessor(name, -12.f, 4.f, 2.f, 50.f);
+    }, seconds) });
+
+    benchmarks.push_back({ "ReverbProcessor", effect([](const std::string& name) {
+        return new ReverbProcessor(name);
+    }, seconds) });
+
+    benchmarks.push_back({ "DelayProcessor", effect([](const std::string& name) {
+        return new DelayProcessor(name, "linear", 200.f, .3f);
+    }, seconds) });
+
+    benchmarks.push_back({ "PannerProcessor", effect([](const std::string& name) {
+        return new PannerProcessor(name, "linear", .3f);
+    }, seconds) });
+
+    benchmarks.push_back({ "AddProcessor", [seconds](DAG& dag, double, int) {
+        std::vector<std::string> inputs;
+        for (int i = 0; i < 4; i++) {
+            auto playback = std::make_shared<PlaybackProcessor>("noise_" + std::to_string(i), makeNoise(seconds + 1.));
+            dag.nodes.push_back(makeDagNode(playback));
+            inputs.push_back(playback->getUniqueName());
+        }
+        dag.nodes.push_back(makeDagNode(std::make_shared<AddProcessor>("add", std::vector<float>(4, .25f)), inputs));
+        return std::string("add");
+    } });
+
+    benchmarks.push_back({ "PlaybackProcessor", [seconds](DAG& dag, double, int) {
+        dag.nodes.push_back(makeDagNode(std::make_shared<PlaybackProcessor>("playback", makeNoise(seconds + 1.))));
+        return std::string("playback");
+    } });
+
+#ifdef BUILD_DAWDREAMER_RUBBERBAND
+    benchmarks.push_back({ "PlaybackWarpProcessor", [seconds](DAG& dag, double sampleRate, int) {
+        auto processor = std::make_shared<PlaybackWarpProcessor>("playback_warp", makeNoise(seconds + 1.), sampleRate);
+        processor->setTimeRatio(1.5);
+        processor->setTranspose(3.f);
+        dag.nodes.push_back(makeDagNode(processor));
+        return std::string("playback_warp");
+    } });
+#endif
+
+    benchmarks.push_back({ "SamplerProcessor", [seconds](DAG& dag, double sampleRate, int blockSize) {
+        auto processor = std::make_shared<SamplerProcessor>("sampler", makeNoise(1.), sampleRate, blockSize);
+        addNotes(*processor, seconds);
+        dag.nodes.push_back(makeDagNode(processor));
+        return std::string("sampler");
+    } });
+
+#ifdef BUILD_DAWDREAMER_FAUST
+    benchmarks.push_back({ "FaustProcessor", [seconds](DAG& dag, double sampleRate, int blockSize) {
+        dag.nodes.push_back(makeDagNode(std::make_shared<PlaybackProcessor>("noise", makeNoise(seconds + 1.))));
+        dag.nodes.push_back(makeDagNode(makeFaustProcessor("faust", FAUST_EFFECT, 0, sampleRate, blockSize), { "noise" }));
+        return std::string("faust");
+    } });
+
+    benchmarks.push_back({ "FaustProcessorPoly", [seconds](DAG& dag, double sampleRate, int blockSize) {
+        auto processor = makeFaustProcessor("faust_poly", FAUST_INSTRUMENT, 8, sampleRate, blockSize);
+        addNotes(*processor, seconds);
+        dag.nodes.push_back(makeDagNode(processor));
+        return std::string("faust_poly");
+    } });
+#endif
+
+    return benchmarks;
+}
+
+std::vector<std::pair<std::string, GraphFactory>>
+makeTopologyBenchmarks(double seconds) {
+
+    std::vector<std::pair<std::string, GraphFactory>> benchmarks;
+
+    // A long series of effects.
+    benchmarks.push_back({ "chain", [seconds](DAG& dag, double, int) {
+        dag.nodes.push_back(makeDagNode(std::make_shared<PlaybackProcessor>("noise", makeNoise(seconds + 1.))));
+        std::string previous = "noise";
+        for (int i = 0; i < 32; i++) {
+            auto filter = std::make_shared<FilterProcessor>("filter_" + std::to_string(i), "low", 5000.f - 100.f * i, .707f, 1.f);
+            dag.nodes.push_back(makeDagNode(filter, { previous }));
+            previous = filter->getUniqueName();
+        }
+        return std::string();
+    } });
+
+    // Many sources summed by one processor.
+    benchmarks.push_back({ "fan_in", [seconds](DAG& dag, double, int) {
+        std::vector<std::string> inputs;
+        for (int i = 0; i < 32; i++) {
+            auto playback = std::make_shared<PlaybackProcessor>("noise_" + std::to_string(i), makeNoise(seconds + 1.));
+            dag.nodes.push_back(makeDagNode(playback));
+            inputs.push_back(playback->getUniqueName());
+        }
+        dag.nodes.push_back(makeDagNode(std::make_shared<AddProcessor>("add", std::vector<float>()), inputs));
+        return std::string();
+    } });
+
+    // Many independent tracks with effects, mixed together. This is where multiple threads help.
+    benchmarks.push_back({ "wide_mix", [seconds](DAG& dag, double, int) {
+        std::vector<std::string> inputs;
+        for (int i = 0; i < 16; i++) {
+            auto suffix = "_" + std::to_string(i);
+            dag.nodes.push_back(makeDagNode(std::make_shared<PlaybackProcessor>("noise" + suffix, makeNoise(seconds + 1.))));
+            dag.nodes.push_back(makeDagNode(std::make_shared<FilterProcessor>("filter" + suffix, "high", 100.f, .707f, 1.f), { "noise" + suffix }));
+            dag.nodes.push_back(makeDagNode(std::make_shared<CompressorProcessor>("compressor" + suffix, -12.f, 4.f, 2.f, 50.f), { "filter" + suffix }));
+            dag.nodes.push_back(makeDagNode(std::make_shared<ReverbProcessor>("reverb" + suffix), { "compressor" + suffix }));
+            inputs.push_back("reverb" + suffix);
+        }
+        dag.nodes.push_back(makeDagNode(std::make_shared<AddProcessor>("add", std::vector<float>()), inputs));
+        return std::string();
+    } });
+
+    return benchmarks;
+}
+
+// Render the graph options.repetitions times and keep the fastest repetition.
+BenchmarkResult
+runBenchmark(const std::string& name, const GraphFactory& makeGraph, int blockSize, int numThreads, const BenchmarkOptions& options) {
+
+    BenchmarkResult best;
+    best.name = name;
+    best.blockSize = blockSize;
+    best.numThreads = numThreads > 0 ? numThreads : juce::SystemStats::getNumCpus();
+
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+        RenderEngine engine(SAMPLE_RATE, blockSize);
+        engine.setNumThreads(numThreads);
+
+        DAG dag;
+        const std::string measuredName = makeGraph(dag, SAMPLE_RATE, blockSize);
+        if (!engine.loadGraph(dag, 2, 2)) {
+            std::cerr << "Unable to load the graph of " << name << "." << std::endl;
+            return best;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        engine.render(options.seconds);
+        const double wallNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        BenchmarkResult result = best;
+        result.numSamples = (juce::int64)(options.seconds * SAMPLE_RATE);
+        result.wallNs = wallNs;
+
+        for (auto& stats : engine.getProfileStats()) {
+            if (!measuredName.empty() && stats.name == measuredName) {
+                result.hasProcessorStats = true;
+                result.processorStats = stats;
+            }
+        }
+
+        const bool isFaster = result.hasProcessorStats ?
+            (!best.hasProcessorStats || result.processorStats.totalNs < best.processorStats.totalNs) :
+            (best.wallNs == 0. || result.wallNs < best.wallNs);
+        if (isFaster) {
+            best = result;
+        }
+    }
+
+    return best;
+}
+
+juce::var
+toJSON(const BenchmarkResult& result) {
+
+    auto object = new juce::DynamicObject();
+
+    object->setProperty("name", juce::String(result.name));
+    object->setProperty("block_size", result.blockSize);
+    object->setProperty("num_threads", result.numThreads);
+    object->setProperty("num_samples", result.numSamples);
+    object->setProperty("wall_ns", result.wallNs);
+    object->setProperty("samples_per_second", result.wallNs > 0. ? (double)result.numSamples / (result.wallNs * 1e-9) : 0.);
+
+    if (result.hasProcessorStats) {
+        auto& stats = result.processorStats;
+        object->setProperty("process_total_ns", stats.totalNs);
+        object->setProperty("process_mean_ns", stats.meanNs);
+        object->setProperty("process_max_ns", stats.maxNs);
+        object->setProperty("process_p99_ns", stats.p99Ns);
+        object->setProperty("blocks", stats.blocks);
+        // Throughput of the processor on its own, excluding the rest of the graph.
+        object->setProperty("process_samples_per_second", stats.totalNs > 0 ? (double)result.numSamples / ((double)stats.totalNs * 1e-9) : 0.);
+    }
+
+    return juce::var(object);
+}
+
+bool
+parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (i + 1 >= argc) {
+            std::cerr << "Missing a value for " << arg << "." << std::endl;
+            return false;
+        }
+        std::string value(argv[++i]);
+        if (arg == "--json") {
+            options.jsonPath = value;
+        }
+        else if (arg == "--seconds") {
+            options.seconds = std::stod(value);
+        }
+        else if (arg == "--repetitions") {
+            options.repetitions = std::max(1, std::stoi(value));
+        }
+        else if (arg == "--filter") {
+            options.filter = value;
+        }
+        else {
+            std::cerr << "Unknown option " << arg << "." << std::endl;
+            return false;
+        }
+    }
+    return options.seconds > 0.;
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: dawdreamer_benchmark [--json path] [--seconds 2] [--repetitions 3] [--filter name]" << std::endl;
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const std::vector<int> blockSizes = { 1, 16, 64, 256, 1024, 4096 };
+    const int topologyBlockSize = 512;
+
+    juce::Array<juce::var> results;
+
+    auto run = [&](const std::string& name, const GraphFactory& makeGraph, int blockSize, int numThreads) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        auto result = runBenchmark(name, makeGraph, blockSize, numThreads, options);
+        std::cerr << name << " block_size=" << blockSize << " num_threads=" << numThreads << ": "
+            << (result.hasProcessorStats ? result.processorStats.totalNs : (juce::int64)result.wallNs) / 1000000. << " ms" << std::endl;
+        results.add(toJSON(result));
+    };
+
+    for (auto& [name, makeGraph] : makeProcessorBenchmarks(options.seconds)) {
+        for (int blockSize : blockSizes) {
+            run(name, makeGraph, blockSize, 1);
+        }
+    }
+
+    for (auto& [name, makeGraph] : makeTopologyBenchmarks(options.seconds)) {
+        run(name, makeGraph, topologyBlockSize, 1);
+        run(name, makeGraph, topologyBlockSize, 0);
+    }
+
+    auto report = new juce::DynamicObject();
+    report->setProperty("sample_rate", SAMPLE_RATE);
+    report->setProperty("render_seconds", options.seconds);
+    report->setProperty("repetitions", options.repetitions);
+    report->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    report->setProperty("benchmarks", results);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (options.jsonPath.empty()) {
+        std::cout << json << std::endl;
+    }
+    else if (!juce::File(options.jsonPath).replaceWithText(json)) {
+        std::cerr << "Unable to write " << options.jsonPath << "." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
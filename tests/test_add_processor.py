@@ -0,0 +1,78 @@
+from utils import *
+
+BUFFER_SIZE = 128
+DURATION = 1.
+
+def test_add_processor_automation():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	engine.automation_interval = 1
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	rng = np.random.default_rng(0)
+	audios = [rng.uniform(-.3, .3, size=(2, num_samples)).astype(np.float32) for _ in range(3)]
+
+	playbacks = [engine.make_playback_processor(f"playback{i}", audio) for i, audio in enumerate(audios)]
+	add = engine.make_add_processor("add", [.5, 1., -2.])
+
+	ramp = np.linspace(0., 1., num=num_samples, dtype=np.float32)
+	assert(add.set_automation("gain_1", ramp))
+
+	graph = [(playback, []) for playback in playbacks]
+	graph.append((add, [playback.get_name() for playback in playbacks]))
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	expected = .5*audios[0] + ramp*audios[1] - 2.*audios[2]
+	assert(np.allclose(engine.get_audio(), expected, atol=1e-5))
+
+	assert(np.allclose(add.gain_levels, [.5, 0., -2.]))
+	add.gain_levels = [1., 1., 1.]
+	assert(np.allclose(add.gain_levels, [1., 1., 1.]))
+	# The gain parameters are made with the processor, so there can't be more of them.
+	add.gain_levels = [1., 1., 1., 1.]
+	assert(np.allclose(add.gain_levels, [1., 1., 1.]))
+
+def test_add_processor_many_inputs():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	rng = np.random.default_rng(1)
+	audios = [rng.uniform(-.1, .1, size=(2, num_samples)).astype(np.float32) for _ in range(64)]
+
+	playbacks = [engine.make_playback_processor(f"playback{i}", audio) for i, audio in enumerate(audios)]
+	add = engine.make_add_processor("add")
+
+	graph = [(playback, []) for playback in playbacks]
+	graph.append((add, [playback.get_name() for playback in playbacks]))
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	assert(np.allclose(engine.get_audio(), np.sum(audios, axis=0), atol=1e-5))
+
+def test_add_processor_mixed_widths():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	rng = np.random.default_rng(2)
+	mono1 = rng.uniform(-.3, .3, size=(1, num_samples)).astype(np.float32)
+	mono2 = rng.uniform(-.3, .3, size=(1, num_samples)).astype(np.float32)
+	stereo = rng.uniform(-.3, .3, size=(2, num_samples)).astype(np.float32)
+
+	graph = [
+		(engine.make_playback_processor("mono1", mono1), [], 1),
+		(engine.make_playback_processor("mono2", mono2), [], 1),
+		(engine.make_playback_processor("stereo", stereo), []),
+		(engine.make_add_processor("add", [1., .5, 1.]), ["mono1", "mono2", "stereo"]),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	# The mono inputs go to both output channels.
+	expected = mono1 + .5*mono2 + stereo
+	assert(np.allclose(engine.get_audio(), expected, atol=1e-5))
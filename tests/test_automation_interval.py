@@ -0,0 +1,57 @@
+from utils import *
+
+DURATION = 2.
+
+def _render_filter(freq_automation, buffer_size, automation_interval=0):
+
+	engine = daw.RenderEngine(SAMPLE_RATE, buffer_size)
+	engine.automation_interval = automation_interval
+	engine.profile = True
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=DURATION+.1)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	assert(the_filter.set_automation("freq", freq_automation))
+
+	graph = [
+		(playback, []),
+		(the_filter, [playback.get_name()]),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	return np.array(engine.get_audio()), engine.get_profile()
+
+def test_automation_interval_steps():
+
+	# Automation that changes value every 1000 samples.
+	num_samples = int(DURATION*SAMPLE_RATE)
+	freq_automation = np.repeat(np.linspace(200., 8000., num=num_samples//1000+1), 1000)[:num_samples].astype(np.float32)
+
+	audio_reference, _ = _render_filter(freq_automation, 1)
+	audio_stepped, _ = _render_filter(freq_automation, 512)
+	audio_split, profile = _render_filter(freq_automation, 512, automation_interval=1)
+
+	assert(np.allclose(audio_reference, audio_split, atol=1e-6))
+	assert(not np.allclose(audio_reference, audio_stepped, atol=1e-6))
+
+	# Sub-blocks are counted as part of their block.
+	assert(profile["filter"]["blocks"] == profile["_render"]["blocks"])
+
+	wavfile.write('output/test_automation_interval_steps.wav', SAMPLE_RATE, audio_split.transpose())
+
+def test_automation_interval_sweep():
+
+	# Automation that changes value every sample.
+	freq_automation = np.linspace(200., 8000., num=int(DURATION*SAMPLE_RATE), dtype=np.float32)
+
+	audio_reference, _ = _render_filter(freq_automation, 1)
+	audio_split, _ = _render_filter(freq_automation, 512, automation_interval=1)
+	assert(np.allclose(audio_reference, audio_split, atol=1e-6))
+
+	audio_reference, _ = _render_filter(freq_automation, 32)
+	audio_split, _ = _render_filter(freq_automation, 512, automation_interval=32)
+	assert(np.allclose(audio_reference, audio_split, atol=1e-6))
@@ -0,0 +1,96 @@
+from utils import *
+
+BUFFER_SIZE = 1
+DURATION = 2.
+
+def _render_filter(set_freq_automation):
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=DURATION+.1)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	assert(set_freq_automation(the_filter))
+
+	graph = [
+		(playback, []),
+		(the_filter, [playback.get_name()]),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	return np.array(engine.get_audio()), the_filter.get_automation("freq")
+
+def test_automation_control_rate():
+
+	control_rate = 100.
+	control = np.linspace(200., 8000., num=int(DURATION*control_rate)+1, dtype=np.float32)
+
+	# The same automation at the audio rate.
+	times = np.arange(int(DURATION*SAMPLE_RATE)) / SAMPLE_RATE
+	dense = np.interp(times, np.arange(len(control)) / control_rate, control).astype(np.float32)
+
+	audio_control, automation = _render_filter(lambda f: f.set_automation("freq", control, mode="control", rate=control_rate))
+	audio_dense, _ = _render_filter(lambda f: f.set_automation("freq", dense))
+
+	assert(np.allclose(automation[:len(dense)], dense, rtol=1e-4))
+	assert(np.allclose(audio_control, audio_dense, atol=1e-4))
+
+	wavfile.write('output/test_automation_control_rate.wav', SAMPLE_RATE, audio_control.transpose())
+
+def test_automation_breakpoints():
+
+	breakpoints = np.array([
+		[0., 200.],
+		[.5, 4000.],
+		[1.5, 1000.],
+	])
+
+	times = np.arange(int(DURATION*SAMPLE_RATE)) / SAMPLE_RATE
+	dense = np.interp(times, breakpoints[:, 0], breakpoints[:, 1]).astype(np.float32)
+
+	audio_breakpoints, automation = _render_filter(lambda f: f.set_automation("freq", breakpoints, mode="breakpoints"))
+	audio_dense, _ = _render_filter(lambda f: f.set_automation("freq", dense))
+
+	assert(len(automation) == int(1.5*SAMPLE_RATE)+1)
+	assert(np.allclose(audio_breakpoints, audio_dense, atol=1e-4))
+
+	# Curved segments keep their end points.
+	curved = np.array([
+		[0., 200., 4.],
+		[1., 4000., -4.],
+		[2., 200., 0.],
+	])
+	_, automation = _render_filter(lambda f: f.set_automation("freq", curved, mode="breakpoints"))
+	assert(np.isclose(automation[0], 200.))
+	assert(np.isclose(automation[SAMPLE_RATE], 4000.))
+	assert(automation[SAMPLE_RATE//2] < 2100.)
+	assert(automation[SAMPLE_RATE*3//2] < 1000.)
+
+def test_automation_ppq():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+	engine.set_bpm(60.)
+
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	# At 60 BPM a quarter note lasts one second.
+	assert(the_filter.set_automation("freq", np.array([[0., 200.], [1., 1200.]]), mode="breakpoints", ppq=True))
+
+	assert(engine.load_graph([(engine.make_oscillator_processor("osc", 440.), []), (the_filter, ["osc"])]))
+	engine.render(1.)
+
+	automation = the_filter.get_automation("freq")
+	assert(len(automation) == SAMPLE_RATE+1)
+	assert(np.isclose(automation[SAMPLE_RATE//2], 700.))
+
+def test_automation_invalid():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+
+	assert(not the_filter.set_automation("freq", np.zeros(10), mode="control"))
+	assert(not the_filter.set_automation("freq", np.array([[1., 200.], [0., 400.]]), mode="breakpoints"))
+	assert(not the_filter.set_automation("freq", np.zeros(10), mode="unknown"))
@@ -72,3 +72,37 @@ def test_faust_poly():
 	audio2 = _test_faust_poly('output/test_faust_poly_automation_decay_ungrouped.wav', group_voices=False, decay=.5)
 
 	assert(np.allclose(audio1[:,:-1], audio2[:,:-1]))  # todo: don't drop last sample
+
+def test_faust_poly_load_graph():
+
+	# load_graph compiles these at once, and every polyphonic instance shares Faust's list of voice groups.
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+
+	dsp_path = abspath("faust_dsp/polyphonic.dsp")
+	processors = []
+	for i in range(4):
+		processor = engine.make_faust_processor(f"faust{i}")
+		assert(processor.set_dsp(dsp_path))
+		processor.group_voices = True
+		processor.num_voices = 8
+		processor.add_midi_note(60+4*i, 100, 0.0, .5)
+		processor.record = True
+		processors.append(processor)
+
+	graph = [(processor, []) for processor in processors]
+	graph.append((engine.make_add_processor("add", [1.]*4), [processor.get_name() for processor in processors]))
+
+	assert(engine.load_graph(graph))
+	assert(all(processor.compiled for processor in processors))
+
+	render(engine, file_path='output/test_faust_poly_load_graph.wav', duration=1.)
+
+	for processor in processors:
+		assert(np.abs(processor.get_audio()).max() > .01)
+
+	# The grouped voices of each processor are updated on whichever thread renders it.
+	audios = [processor.get_audio().copy() for processor in processors]
+	engine.num_threads = 4
+	render(engine, duration=1.)
+	for processor, audio in zip(processors, audios):
+		assert(np.allclose(processor.get_audio(), audio))
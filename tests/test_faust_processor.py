@@ -138,3 +138,122 @@ def test_faust_automation():
 	assert(engine.load_graph(graph))
 
 	render(engine, file_path='output/test_faust_automation.wav')
+
+def test_faust_cache(tmp_path):
+
+	DURATION = 1.
+
+	dsp_code = 'process = os.osc(440.)*.1 <: _, _;'
+
+	def render_faust(name):
+		engine = daw.RenderEngine(SAMPLE_RATE, 128)
+		faust_processor = engine.make_faust_processor(name)
+		assert(faust_processor.set_dsp_string(dsp_code))
+		assert(faust_processor.compile())
+		assert(engine.load_graph([(faust_processor, [])]))
+		engine.render(DURATION)
+		return engine.get_audio()
+
+	cache_dir = str(tmp_path / "faust_cache")
+	assert(daw.FaustProcessor.set_cache_dir(cache_dir))
+	assert(daw.FaustProcessor.get_cache_dir() == cache_dir)
+
+	try:
+		audio = render_faust("faust1")
+		assert(len(list((tmp_path / "faust_cache").iterdir())) == 1)
+
+		# Without the factories in memory, the factory is loaded from the cache directory.
+		daw.FaustProcessor.clear_cache()
+		assert(np.allclose(audio, render_faust("faust2")))
+		assert(len(list((tmp_path / "faust_cache").iterdir())) == 1)
+	finally:
+		daw.FaustProcessor.set_cache_dir("")
+		daw.FaustProcessor.clear_cache()
+
+def test_faust_clone():
+
+	DURATION = 1.
+
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+
+	faust_processor = engine.make_faust_processor("faust1")
+	assert(faust_processor.set_dsp_string('declare name "MyOsc"; process = os.osc(hslider("freq", 440., 20., 2000., .01))*.1 <: _, _;'))
+	assert(faust_processor.compile())
+	faust_processor.set_parameter("/MyOsc/freq", 220.)
+
+	clone = faust_processor.clone("faust2")
+	assert(clone.get_name() == "faust2")
+	assert(clone.compiled)
+	assert(clone.get_parameter("/MyOsc/freq") == 220.)
+
+	# The clone has its own parameters.
+	clone.set_parameter("/MyOsc/freq", 330.)
+	assert(faust_processor.get_parameter("/MyOsc/freq") == 220.)
+
+	graph = [
+		(faust_processor, []),
+		(clone, []),
+		(engine.make_add_processor("add", [1., -1.]), ["faust1", "faust2"]),
+	]
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	assert(np.abs(engine.get_audio()).max() > .01)
+
+def test_faust_compile_flags():
+
+	DURATION = 1.
+
+	dsp_code = 'process = no.noise : fi.lowpass(3, 1000.) <: _, _;'
+
+	def render_faust(flags):
+		engine = daw.RenderEngine(SAMPLE_RATE, 128)
+		faust_processor = engine.make_faust_processor("faust")
+		assert(faust_processor.set_dsp_string(dsp_code))
+		faust_processor.compile_flags = flags
+		assert(faust_processor.compile_flags == flags)
+		assert(faust_processor.compile())
+		assert(engine.load_graph([(faust_processor, [])]))
+		engine.render(DURATION)
+		return engine.get_audio()
+
+	# Vectorized code computes the same audio as scalar code.
+	assert(np.allclose(render_faust([]), render_faust(["-vec", "-vs", "32"]), atol=1e-5))
+
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+	faust_processor = engine.make_faust_processor("faust")
+	assert(faust_processor.set_dsp_string(dsp_code))
+
+	times = faust_processor.benchmark_compile_flags([[], ["-vec", "-vs", "32"], ["-not-a-flag"]], duration=DURATION)
+	assert(len(times) == 3)
+	assert(np.isfinite(times[0]) and np.isfinite(times[1]))
+	assert(np.isinf(times[2]))
+
+def test_faust_compile_async():
+
+	DURATION = 1.
+
+	engine = daw.RenderEngine(SAMPLE_RATE, 128)
+
+	faust_processor = engine.make_faust_processor("faust")
+	assert(faust_processor.set_dsp_string('process = os.osc(440.)*.1 <: _, _;'))
+	future = faust_processor.compile_async()
+	assert(future.result())
+	assert(future.done())
+	assert(faust_processor.compiled)
+
+	# load_graph compiles the processors that aren't compiled yet.
+	processors = []
+	for i in range(4):
+		processor = engine.make_faust_processor(f"faust{i}")
+		assert(processor.set_dsp_string(f'process = os.osc({220*(i+1)}.)*.1 <: _, _;'))
+		processors.append(processor)
+
+	graph = [(processor, []) for processor in processors]
+	graph.append((engine.make_add_processor("add", [1.]*4), [processor.get_name() for processor in processors]))
+
+	assert(engine.load_graph(graph))
+	assert(all(processor.compiled for processor in processors))
+
+	engine.render(DURATION)
+	assert(np.abs(engine.get_audio()).max() > .1)
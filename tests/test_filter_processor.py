@@ -0,0 +1,66 @@
+from utils import *
+from scipy import signal
+
+BUFFER_SIZE = 128
+DURATION = 1.
+NUM_CHANNELS = 6
+
+def _lowpass_coefficients(freq, q, sr=SAMPLE_RATE):
+	n = 1. / np.tan(np.pi * freq / sr)
+	b = np.array([1., 2., 1.])
+	a = np.array([1. + n/q + n*n, 2.*(1. - n*n), 1. - n/q + n*n])
+	return b / a[0], a / a[0]
+
+def test_filter_matches_biquad():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	rng = np.random.default_rng(0)
+	# More channels than the filter processes at once.
+	audio = rng.uniform(-.5, .5, size=(NUM_CHANNELS, num_samples)).astype(np.float32)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 1000., 2.)
+
+	assert(engine.load_graph([(playback, [], NUM_CHANNELS), (the_filter, ["playback"], NUM_CHANNELS)]))
+	engine.render(DURATION)
+
+	b, a = _lowpass_coefficients(1000., 2.)
+	expected = signal.lfilter(b, a, audio, axis=1)
+
+	assert(np.allclose(engine.get_audio(), expected, atol=1e-4))
+
+def test_filter_smoothing():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	audio = np.stack([make_sine(440., DURATION)]*2).astype(np.float32)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 4000.)
+
+	# The cutoff jumps halfway through.
+	freq = np.full(num_samples, 4000., dtype=np.float32)
+	freq[num_samples//2:] = 200.
+	assert(the_filter.set_automation("freq", freq))
+
+	assert(engine.load_graph([(playback, []), (the_filter, ["playback"])]))
+
+	assert(not the_filter.smoothing)
+	engine.render(DURATION)
+	stepped = engine.get_audio()
+
+	the_filter.smoothing = True
+	assert(the_filter.smoothing)
+	engine.render(DURATION)
+	smoothed = engine.get_audio()
+
+	wavfile.write('output/test_filter_smoothing.wav', SAMPLE_RATE, smoothed.transpose())
+
+	assert(np.all(np.isfinite(smoothed)))
+	# The two differ only around the jump.
+	assert(not np.allclose(stepped, smoothed))
+	assert(np.allclose(stepped[:, :num_samples//2-BUFFER_SIZE], smoothed[:, :num_samples//2-BUFFER_SIZE]))
+	assert(np.allclose(stepped[:, -BUFFER_SIZE:], smoothed[:, -BUFFER_SIZE:], atol=1e-3))
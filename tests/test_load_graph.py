@@ -0,0 +1,79 @@
+from utils import *
+import gc
+
+BUFFER_SIZE = 128
+DURATION = 3.
+
+def test_reload_graph():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=DURATION+.1)
+
+	playback = engine.make_playback_processor("playback", audio)
+	reverb = engine.make_reverb_processor("reverb")
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	compressor = engine.make_compressor_processor("compressor", threshold=-12.)
+
+	graph_reverb = [
+		(playback, []),
+		(reverb, [playback.get_name()]),
+		(compressor, [reverb.get_name()]),
+	]
+
+	graph_filter = [
+		(playback, []),
+		(the_filter, [playback.get_name()]),
+		(compressor, [the_filter.get_name()]),
+	]
+
+	assert(engine.load_graph(graph_reverb))
+	engine.render(DURATION)
+	audio_reverb = np.array(engine.get_audio())
+
+	assert(engine.load_graph(graph_filter))
+	engine.render(DURATION)
+	audio_filter = np.array(engine.get_audio())
+
+	assert(not np.allclose(audio_reverb, audio_filter))
+
+	# Swapping one effect back and forth must give the same result as the first load.
+	for _ in range(10):
+		assert(engine.load_graph(graph_reverb))
+		assert(engine.load_graph(graph_filter))
+
+	engine.render(DURATION)
+	assert(np.array_equal(audio_filter, engine.get_audio()))
+
+	assert(engine.load_graph(graph_reverb))
+	engine.render(DURATION)
+	assert(np.array_equal(audio_reverb, engine.get_audio()))
+
+def test_reload_graph_releases_processors():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	# The engine keeps processors alive while they're in its graph,
+	# even if Python no longer refers to them. Python only holds a wrapper,
+	# so the processors are counted on the C++ side.
+	osc = engine.make_oscillator_processor("osc", 440.)
+	assert(engine.load_graph([(osc, [])]))
+	num_instances = daw.ProcessorBase.get_num_instances()
+	del osc
+	gc.collect()
+	assert(daw.ProcessorBase.get_num_instances() == num_instances)
+
+	engine.render(.5)
+	audio = np.array(engine.get_audio())
+	assert(np.abs(audio).max() > .1)
+
+	# Loading another graph releases them.
+	osc = engine.make_oscillator_processor("osc", 220.)
+	assert(daw.ProcessorBase.get_num_instances() == num_instances + 1)
+	assert(engine.load_graph([(osc, [])]))
+	gc.collect()
+	assert(daw.ProcessorBase.get_num_instances() == num_instances)
+
+	engine.render(.5)
+	assert(not np.allclose(audio, engine.get_audio()))
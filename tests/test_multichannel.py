@@ -0,0 +1,75 @@
+from utils import *
+
+BUFFER_SIZE = 128
+DURATION = 2.
+NUM_CHANNELS = 6
+
+def _make_audio(num_channels, num_samples):
+	t = np.arange(num_samples) / SAMPLE_RATE
+	return np.stack([np.sin(2.*np.pi*110.*(i+1)*t) * .1 for i in range(num_channels)]).astype(np.float32)
+
+def test_multichannel_graph():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	audio1 = _make_audio(NUM_CHANNELS, num_samples)
+	audio2 = -.5 * audio1[::-1].copy()
+
+	playback1 = engine.make_playback_processor("playback1", audio1)
+	playback2 = engine.make_playback_processor("playback2", audio2)
+	playback1.record = True
+
+	graph = [
+		(playback1, [], NUM_CHANNELS),
+		(playback2, [], NUM_CHANNELS),
+		(engine.make_add_processor("add", [1., 2.]), ["playback1", "playback2"], NUM_CHANNELS),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	output = engine.get_audio()
+	assert(output.shape == (NUM_CHANNELS, num_samples))
+	assert(np.allclose(output, audio1 + 2.*audio2, atol=1e-6))
+
+	assert(playback1.get_audio().shape == (NUM_CHANNELS, num_samples))
+
+	# A stereo processor after a multichannel one takes its first two channels.
+	the_filter = engine.make_filter_processor("filter", "low", 20000.)
+	graph = [
+		(playback1, [], NUM_CHANNELS),
+		(the_filter, ["playback1"]),
+	]
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+	assert(engine.get_audio().shape == (2, num_samples))
+
+	assert(not engine.load_graph([(playback1, [], 0)]))
+
+	wavfile.write('output/test_multichannel_graph.wav', SAMPLE_RATE, output.transpose())
+
+def test_multichannel_filter():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	audio = _make_audio(NUM_CHANNELS, num_samples)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 300.)
+
+	graph = [
+		(playback, [], NUM_CHANNELS),
+		(the_filter, ["playback"], NUM_CHANNELS),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	output = engine.get_audio()
+	assert(output.shape == (NUM_CHANNELS, num_samples))
+
+	# Every channel is filtered: the higher the sine, the quieter it gets.
+	levels = np.abs(output[:, SAMPLE_RATE:]).max(axis=1)
+	assert(np.all(np.diff(levels) < 0.))
@@ -0,0 +1,77 @@
+from utils import *
+
+BUFFER_SIZE = 128
+
+def _render_stems(num_threads):
+
+	DURATION = 5.
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	engine.num_threads = num_threads
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+
+	graph = []
+	stem_names = []
+
+	for stem in ["bass", "drums", "other", "vocals"]:
+		audio = load_audio_file(thisdir+f"assets/Music Delta - Disco/{stem}.wav", duration=DURATION+.1)
+		playback = engine.make_playback_processor(f"playback_{stem}", audio)
+		reverb = engine.make_reverb_processor(f"reverb_{stem}")
+		compressor = engine.make_compressor_processor(f"compressor_{stem}", threshold=-12.)
+
+		graph += [
+			(playback, []),
+			(reverb, [playback.get_name()]),
+			(compressor, [reverb.get_name()]),
+		]
+		stem_names.append(compressor.get_name())
+
+	graph.append((engine.make_add_processor("add", [.25]*len(stem_names)), stem_names))
+
+	assert(engine.load_graph(graph))
+
+	engine.render(DURATION)
+
+	return engine.get_audio()
+
+def test_num_threads():
+
+	audio1 = _render_stems(1)
+	audio4 = _render_stems(4)
+	audio_all = _render_stems(0)
+
+	# Multi-threaded rendering must be bit-for-bit identical to single-threaded rendering.
+	assert(np.array_equal(audio1, audio4))
+	assert(np.array_equal(audio1, audio_all))
+	assert(np.abs(audio1).max() > .01)
+
+	wavfile.write('output/test_num_threads.wav', SAMPLE_RATE, audio4.transpose())
+
+def test_profile():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	graph = [
+		(engine.make_oscillator_processor("osc", 440.), []),
+		(engine.make_reverb_processor("reverb"), ["osc"]),
+	]
+	assert(engine.load_graph(graph))
+
+	# Profiling is off by default.
+	engine.render(1.)
+	assert(engine.get_profile() == {})
+
+	engine.profile = True
+	engine.render(1.)
+
+	profile = engine.get_profile()
+
+	num_blocks = int(np.ceil((SAMPLE_RATE-1.)/BUFFER_SIZE))
+	assert(set(profile.keys()) == {"osc", "reverb", "_render"})
+	for name, stats in profile.items():
+		assert(stats["blocks"] == num_blocks)
+		assert(0 < stats["mean_ns"] <= stats["max_ns"] <= stats["total_ns"])
+		assert(0 < stats["p99_ns"] <= stats["max_ns"])
+
+	assert(profile["_render"]["total_ns"] >= profile["osc"]["total_ns"] + profile["reverb"]["total_ns"])
@@ -43,6 +43,14 @@ def test_record():
 	assert(np.allclose(audio1, audio1_input[:,:audio1.shape[1]], atol=1e-07))
 	assert(np.allclose(audio2, audio2_input[:,:audio1.shape[1]], atol=1e-07))
 
+	# The arrays are views of the recordings, and a new render must not overwrite them.
+	assert(not audio1.flags.writeable)
+	engine.set_bpm(140.)
+	engine.render(DURATION/2.)
+
+	assert(np.allclose(audio1, audio1_input[:,:audio1.shape[1]], atol=1e-07))
+	assert(engine.get_audio(playback1.get_name()).shape[1] < audio1.shape[1])
+
 	audio_missing = engine.get_audio("Invalid Name")
 
 	assert(audio_missing.shape[0] == 2)
@@ -51,3 +59,80 @@ def test_record():
 	wavfile.write(thisdir+'output/test_record_both.wav', SAMPLE_RATE, output.transpose())
 	wavfile.write(thisdir+'output/test_record_1.wav', SAMPLE_RATE, audio1.transpose())
 	wavfile.write(thisdir+'output/test_record_2.wav', SAMPLE_RATE, audio2.transpose())
+
+def test_record_to_file():
+
+	DURATION = 5.
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+
+	audio_input = load_audio_file(thisdir+"assets/Music Delta - Disco/bass.wav", duration=5.1)
+	playback = engine.make_playback_processor("playback", audio_input)
+	playback.record = True
+	playback.record_to_file(thisdir+'output/test_record_to_file.wav', bit_depth=32)
+
+	assert(engine.load_graph([(playback, [])]))
+
+	engine.render(DURATION)
+
+	audio = playback.get_audio()
+
+	rate, audio_file = wavfile.read(thisdir+'output/test_record_to_file.wav')
+	assert(rate == SAMPLE_RATE)
+	audio_file = audio_file.transpose()
+
+	assert(audio_file.shape == audio.shape)
+	assert(np.allclose(audio_file, audio, atol=1e-07))
+
+def test_record_options():
+
+	DURATION = 5.
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+
+	audio_input = load_audio_file(thisdir+"assets/Music Delta - Disco/bass.wav", duration=5.1)
+
+	playbacks = [engine.make_playback_processor(f"playback{i}", audio_input) for i in range(4)]
+	for playback in playbacks:
+		playback.record = True
+
+	assert(playbacks[0].set_recording_options(channels=[1]))
+	assert(playbacks[1].set_recording_options(dtype="int16", decimation=4))
+	assert(playbacks[2].set_recording_options(dtype="float16", start=1., end=2.))
+	assert(playbacks[3].set_recording_options(channels=[1, 0, 5], decimation=3, start=.5))
+
+	assert(not playbacks[3].set_recording_options(dtype="int8"))
+	assert(not playbacks[3].set_recording_options(decimation=0))
+	assert(not playbacks[3].set_recording_options(start=2., end=1.))
+
+	assert(engine.load_graph([(playback, []) for playback in playbacks]))
+
+	engine.render(DURATION)
+
+	num_samples = int(DURATION*SAMPLE_RATE)
+	expected = audio_input[:, :num_samples]
+
+	audio = playbacks[0].get_audio()
+	assert(audio.shape == (1, num_samples))
+	assert(np.allclose(audio, expected[1:2], atol=1e-07))
+
+	audio = playbacks[1].get_audio()
+	assert(audio.dtype == np.int16)
+	assert(audio.shape == (2, (num_samples+3)//4))
+	assert(np.allclose(audio / 32767., expected[:, ::4], atol=1e-4))
+
+	audio = playbacks[2].get_audio()
+	assert(audio.dtype == np.float16)
+	assert(audio.shape == (2, SAMPLE_RATE))
+	assert(np.array_equal(audio, expected[:, SAMPLE_RATE:2*SAMPLE_RATE].astype(np.float16)))
+
+	audio = playbacks[3].get_audio()
+	start = SAMPLE_RATE//2
+	assert(audio.shape == (3, (num_samples-start+2)//3))
+	assert(np.allclose(audio[0], expected[1, start::3], atol=1e-07))
+	assert(np.allclose(audio[1], expected[0, start::3], atol=1e-07))
+	assert(np.all(audio[2] == 0.))
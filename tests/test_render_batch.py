@@ -0,0 +1,60 @@
+from utils import *
+
+BUFFER_SIZE = 128
+DURATION = 3.
+
+def _make_graph(engine):
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=DURATION+.1)
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 1000., .707, 1.)
+	reverb = engine.make_reverb_processor("reverb")
+
+	graph = [
+		(playback, []),
+		(the_filter, [playback.get_name()]),
+		(reverb, [the_filter.get_name()]),
+	]
+
+	return graph, the_filter, reverb
+
+def test_render_batch():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	graph, the_filter, reverb = _make_graph(engine)
+	assert(engine.load_graph(graph))
+
+	freq_automation = np.linspace(200., 8000., num=int(DURATION*SAMPLE_RATE), dtype=np.float32)
+
+	parameter_sets = [
+		{"filter": {"freq": 500.}},
+		{"filter": {"freq": 4000.}, "reverb": {"room_size": .9}},
+		{},
+		{"filter": {"freq": freq_automation}},
+	]
+
+	batch = engine.render_batch(parameter_sets, DURATION, num_threads=2)
+
+	assert(batch.shape == (len(parameter_sets), 2, int(DURATION*SAMPLE_RATE)))
+
+	# The graph's own automation must be unchanged by the batch.
+	assert(the_filter.frequency == 1000.)
+	assert(reverb.room_size == .5)
+
+	# Every render must match a regular render with the same settings.
+	for i, parameter_set in enumerate(parameter_sets):
+		engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+		graph, the_filter, reverb = _make_graph(engine)
+		for processor, parameters in [(the_filter, parameter_set.get("filter", {})), (reverb, parameter_set.get("reverb", {}))]:
+			for name, value in parameters.items():
+				processor.set_automation(name, np.atleast_1d(np.array(value, dtype=np.float32)))
+		assert(engine.load_graph(graph))
+		engine.render(DURATION)
+
+		assert(np.allclose(batch[i], engine.get_audio(), atol=1e-6))
+
+	assert(not np.allclose(batch[0], batch[1]))
+
+	wavfile.write('output/test_render_batch.wav', SAMPLE_RATE, batch[3].transpose())
@@ -0,0 +1,66 @@
+from utils import *
+
+BUFFER_SIZE = 128
+
+def _make_engine():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	data = load_audio_file("assets/575854__yellowtree__d-b-funk-loop.wav")
+	playback_processor = engine.make_playback_processor("playback", data)
+	reverb_processor = engine.make_reverb_processor("reverb")
+
+	graph = [
+	    (playback_processor, []),
+	    (reverb_processor, ["playback"]),
+	]
+
+	assert(engine.load_graph(graph))
+
+	return engine
+
+def test_render_iter():
+
+	DURATION = 5.
+	CHUNK_DURATION = .3  # deliberately not a multiple of the block size
+
+	engine = _make_engine()
+	engine.render(DURATION)
+	expected = engine.get_audio()
+
+	engine = _make_engine()
+	chunks = list(engine.render_iter(DURATION, CHUNK_DURATION))
+
+	assert(all(chunk.shape[1] == int(CHUNK_DURATION*SAMPLE_RATE) for chunk in chunks[:-1]))
+
+	output = np.concatenate(chunks, axis=1)
+
+	assert(output.shape[1] == int(DURATION*SAMPLE_RATE))
+	assert(np.allclose(output[:,:expected.shape[1]-1], expected[:,:-1]))  # todo: don't drop last sample
+
+	wavfile.write('output/test_render_iter.wav', SAMPLE_RATE, output.transpose())
+
+def test_render_iter_abandoned():
+
+	CHUNK_DURATION = .5
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	file_path = thisdir+'output/test_render_iter_abandoned.wav'
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	data = load_audio_file("assets/575854__yellowtree__d-b-funk-loop.wav")
+	playback_processor = engine.make_playback_processor("playback", data)
+	reverb_processor = engine.make_reverb_processor("reverb")
+	reverb_processor.record_to_file(file_path, bit_depth=32)
+
+	assert(engine.load_graph([(playback_processor, []), (reverb_processor, ["playback"])]))
+
+	chunks = engine.render_iter(5., CHUNK_DURATION)
+	chunk = next(chunks)
+
+	# Loading a graph without the reverb ends the streaming render and closes the reverb's file.
+	assert(engine.load_graph([(playback_processor, [])]))
+
+	rate, audio_file = wavfile.read(file_path)
+	assert(rate == SAMPLE_RATE)
+	assert(audio_file.shape[0] >= chunk.shape[1])
@@ -0,0 +1,45 @@
+from utils import *
+
+BUFFER_SIZE = 512
+
+def _make_graph(engine):
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=1.)
+
+	playback = engine.make_playback_processor("playback", audio)
+	reverb = engine.make_reverb_processor("reverb", roomSize=.9)
+
+	return [
+		(playback, []),
+		(reverb, [playback.get_name()]),
+	]
+
+def test_render_until_silent():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	assert(engine.load_graph(_make_graph(engine)))
+
+	seconds = engine.render_until_silent(30., threshold_db=-60., silent_blocks=8)
+	audio = np.array(engine.get_audio())
+
+	# The render goes past the end of the playback audio to capture the reverb's tail, but stops well before the limit.
+	assert(1. < seconds < 30.)
+	assert(audio.shape[1] == int(round(seconds*SAMPLE_RATE)))
+	assert(np.abs(audio[:, -8*BUFFER_SIZE:]).max() < 10**(-60/20))
+
+	# The audio is the same as the start of a regular render.
+	engine.render(seconds + 1.)
+	assert(np.allclose(audio, np.array(engine.get_audio())[:, :audio.shape[1]], atol=1e-6))
+
+	wavfile.write('output/test_render_until_silent.wav', SAMPLE_RATE, audio.transpose())
+
+def test_render_until_silent_limit():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	assert(engine.load_graph([(engine.make_oscillator_processor("osc", 440.), [])]))
+
+	# An oscillator never falls silent, so the render lasts until the limit.
+	seconds = engine.render_until_silent(2.)
+	assert(np.isclose(seconds, 2., atol=1./SAMPLE_RATE))
+	assert(np.array(engine.get_audio()).shape[1] == int(2.*SAMPLE_RATE))
@@ -0,0 +1,60 @@
+from utils import *
+
+BUFFER_SIZE = 128
+DURATION = 10.
+
+def _render(skip_silence, gap=0.):
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+	engine.skip_silent_nodes = skip_silence
+	engine.profile = True
+
+	thisdir = str(pathlib.Path(__file__).parent.resolve()) + '/'
+	audio = load_audio_file(thisdir+"assets/Music Delta - Disco/other.wav", duration=1.)
+	if gap > 0.:
+		# Play the audio again after the gap.
+		silence = np.zeros((audio.shape[0], int(gap*SAMPLE_RATE)), dtype=audio.dtype)
+		audio = np.concatenate([audio, silence, audio], axis=1)
+
+	playback = engine.make_playback_processor("playback", audio)
+	the_filter = engine.make_filter_processor("filter", "low", 1000., .707, 1.)
+	reverb = engine.make_reverb_processor("reverb")
+
+	graph = [
+		(playback, []),
+		(the_filter, [playback.get_name()]),
+		(reverb, [the_filter.get_name()]),
+	]
+
+	assert(engine.load_graph(graph))
+	engine.render(DURATION)
+
+	return np.array(engine.get_audio()), engine.get_profile()
+
+def test_skip_silent_nodes():
+
+	audio, profile = _render(False)
+	audio_skipped, profile_skipped = _render(True)
+
+	assert(audio.shape == audio_skipped.shape)
+	assert(np.allclose(audio, audio_skipped, atol=1e-4))
+
+	# The reverb's tail is about 2.5 seconds, so the end of the render is skipped.
+	assert(np.abs(audio_skipped[:, -SAMPLE_RATE:]).max() == 0.)
+	for name in ["filter", "reverb"]:
+		assert(profile_skipped[name]["total_ns"] < profile[name]["total_ns"])
+
+	wavfile.write('output/test_skip_silent_nodes.wav', SAMPLE_RATE, audio_skipped.transpose())
+
+def test_skip_silent_nodes_resume():
+
+	# The filter and reverb are skipped during the gap and start from silence when the audio resumes.
+	audio, profile = _render(False, gap=4.)
+	audio_skipped, profile_skipped = _render(True, gap=4.)
+
+	assert(audio.shape == audio_skipped.shape)
+	assert(np.allclose(audio, audio_skipped, atol=1e-4))
+	for name in ["filter", "reverb"]:
+		assert(profile_skipped[name]["total_ns"] < profile[name]["total_ns"])
+
+	wavfile.write('output/test_skip_silent_nodes_resume.wav', SAMPLE_RATE, audio_skipped.transpose())
@@ -0,0 +1,80 @@
+from utils import *
+
+BUFFER_SIZE = 128
+
+def _make_engine():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	# Two bars at 120 BPM followed by 60 BPM, so quarter note 4 is at 2 seconds and quarter note 5 is at 3 seconds.
+	assert(engine.set_tempo_map([(0., 120.), (4., 60.)]))
+
+	return engine
+
+def test_tempo_map_automation():
+
+	engine = _make_engine()
+
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	assert(the_filter.set_automation("freq", np.array([[0., 200.], [8., 1000.]]), mode="breakpoints", ppq=True))
+
+	graph = [
+		(engine.make_oscillator_processor("osc", 440.), []),
+		(the_filter, ["osc"]),
+	]
+	assert(engine.load_graph(graph))
+	engine.render(1.)
+
+	automation = the_filter.get_automation("freq")
+	# Quarter note 8 is at 2 + 4 seconds.
+	assert(len(automation) == 6*SAMPLE_RATE+1)
+	assert(np.isclose(automation[SAMPLE_RATE], 300.))
+	assert(np.isclose(automation[3*SAMPLE_RATE], 700.))
+
+def test_tempo_map_midi():
+
+	engine = _make_engine()
+
+	faust_processor = engine.make_faust_processor("faust")
+	faust_processor.num_voices = 1
+	assert(faust_processor.set_dsp_string('process = button("gate") <: _, _;'))
+	assert(faust_processor.compile())
+
+	faust_processor.add_midi_note(60, 100, 2., .5, beats=True)
+	faust_processor.add_midi_note(60, 100, 5., .5, beats=True)
+	assert(faust_processor.n_midi_events == 2*2)
+
+	assert(engine.load_graph([(faust_processor, [])]))
+	engine.render(4.)
+
+	audio = np.array(engine.get_audio())[0]
+	onsets = np.flatnonzero(np.diff((audio > .5).astype(np.int32)) == 1) + 1
+
+	assert(len(onsets) == 2)
+	assert(abs(onsets[0] - SAMPLE_RATE) <= 1)
+	assert(abs(onsets[1] - 3*SAMPLE_RATE) <= 1)
+
+def test_tempo_map_linear():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	# Ramp from 60 to 180 BPM over 8 quarter notes. The time of quarter note 8 is 60/15 * ln(3) seconds.
+	assert(engine.set_tempo_map([(0., 60., True), (8., 180.)]))
+
+	the_filter = engine.make_filter_processor("filter", "low", 1000.)
+	assert(the_filter.set_automation("freq", np.array([[0., 200.], [8., 1000.]]), mode="breakpoints", ppq=True))
+	assert(engine.load_graph([(engine.make_oscillator_processor("osc", 440.), []), (the_filter, ["osc"])]))
+	engine.render(1.)
+
+	automation = the_filter.get_automation("freq")
+	assert(abs(len(automation) - 4.*np.log(3.)*SAMPLE_RATE) <= 2)
+
+def test_tempo_map_invalid():
+
+	engine = daw.RenderEngine(SAMPLE_RATE, BUFFER_SIZE)
+
+	assert(not engine.set_tempo_map([(1., 120.)]))
+	assert(not engine.set_tempo_map([(0., 120.), (0., 100.)]))
+	assert(not engine.set_tempo_map([(0., -1.)]))
+	assert(not engine.set_time_signatures([(4., 3, 4), (2., 4, 4)]))
+	assert(engine.set_time_signatures([(0., 3, 4), (6., 7, 8)]))